@@ -0,0 +1,41 @@
+#ifndef LFUDA_ARC_CACHE_H
+#define LFUDA_ARC_CACHE_H
+
+#include "cache.h"
+#include "dllist.h"
+#include "hashtab.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef void *arc_t;
+
+// Initialize Adaptive Replacement Cache. Keys of up to size evicted entries are remembered as well, so indices that are
+// not owned by the cache (key_size is 0) must stay valid for longer than with LFU or LFU-DA
+arc_t arc_init(cache_init_t init);
+
+// Free cache
+void arc_free(arc_t cache_);
+
+// Get page by index
+void *arc_get(arc_t cache_, void *index);
+
+// Get pages for a batch of indices. Keys are looked up together with prefetching and then the gets are applied in
+// order, so results[i] and the state of the cache are the same as after arc_get calls for every index one by one
+void arc_get_many(arc_t cache_, void **indices, void **results, size_t count);
+
+// Get current hits
+size_t arc_get_hits(arc_t cache_);
+
+// Get current target size of the list of entries that have been requested once
+size_t arc_get_target(arc_t cache_);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,6 +12,14 @@ extern "C" {
 #endif
 
 typedef void *(*cache_get_page_t)(void *index);
+// Loader for pages of variable length, which returns the page and stores its length in *length
+typedef void *(*cache_get_sized_page_t)(void *index, size_t *length);
+// Starts an asynchronous load of the page of index, the page is passed to the complete_load function of the cache later
+typedef void (*cache_start_load_t)(void *index);
+// Receives the page of an asynchronous get, which is valid until the cache is used again
+typedef void (*cache_callback_t)(void *ctx, void *page);
+// Loader that writes the page of index directly into dst of cap bytes inside the cache. Returns 0 on success
+typedef int (*cache_fill_page_t)(void *index, void *dst, size_t cap);
 
 // Initializer struct for cache
 typedef struct {
@@ -22,11 +30,37 @@ typedef struct {
     // Optional free function
     entry_free_func_t free;
     size_t size, data_size;
+    // Optional size of the indices. When set, the cache copies index bytes into its own storage, so that the caller
+    // does not have to keep them alive. Hash and cmp receive pointers to the indices instead of pointers to pointers
+    size_t key_size;
+    // Optional hash table backend, HASHTAB_DEFAULT if not set
+    hashtab_backend_t backend;
+    // Optional loader of pages of variable length, which is used instead of get and data_size. Pages are copied into
+    // size-class slabs and the cache holds at most size entries, which take at most capacity bytes of the slabs
+    cache_get_sized_page_t get_sized;
+    size_t capacity;
+    // Optional W-TinyLFU admission for caches of fixed size pages. New entries go to a small LRU window first, and the
+    // least recently used entry of the window only replaces the victim of the cache if it has been seen more often
+    int admission;
+    // Optional asynchronous loader of fixed size pages, which is used by the misses of get_async. The misses of the
+    // same index wait for a single load, and the page is inserted when the load is completed
+    cache_start_load_t start_load;
+    // Optional read guards for caches of fixed size pages, see lfuda_read_begin. Pages of evicted entries are not
+    // overwritten while they may be read without the lock of the cache, so the cache may take more than size pages
+    int read_guards;
+    // Optional loader of fixed size pages, which is used instead of get. The page is written into the slot chosen by
+    // eviction, so there is no copy of it, and gets return the page in the cache on misses as well. When the fill
+    // fails, the get returns NULL and nothing is inserted, but the victim is still evicted
+    cache_fill_page_t fill;
 } cache_init_t;
 
-#define CACHE_HASH_F(func) ((hash_func_t)(func))
-#define CACHE_CMP_F(func)  ((entry_cmp_func_t)(func))
-#define CACHE_GET_F(func)  ((cache_get_page_t)(func))
+#define CACHE_HASH_F(func)       ((hash_func_t)(func))
+#define CACHE_CMP_F(func)        ((entry_cmp_func_t)(func))
+#define CACHE_GET_F(func)        ((cache_get_page_t)(func))
+#define CACHE_GET_SIZED_F(func)  ((cache_get_sized_page_t)(func))
+#define CACHE_START_LOAD_F(func) ((cache_start_load_t)(func))
+#define CACHE_CALLBACK_F(func)   ((cache_callback_t)(func))
+#define CACHE_FILL_F(func)       ((cache_fill_page_t)(func))
 
 #ifdef __cplusplus
 }
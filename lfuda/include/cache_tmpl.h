@@ -0,0 +1,446 @@
+// Type-specialised LFU and LFU-DA caches. lfu_t and lfuda_t call hash, cmp and get through function pointers, so they
+// can't be inlined. This header is a template that generates the same caches for a single key type with direct calls,
+// together with the hash table they use. Keys and values are stored by value in the cache.
+//
+// Define the parameters and include the header once per key type. All generated functions are static inline:
+//
+//     #define CACHE_TMPL_PREFIX u64      // Prefix of the generated names, e.g. u64_lfuda_get
+//     #define CACHE_TMPL_KEY uint64_t    // Key type
+//     #define CACHE_TMPL_VALUE page_t    // Type of the cached values
+//     #define CACHE_TMPL_HASH u64_hash   // unsigned long (KEY)
+//     #define CACHE_TMPL_CMP u64_cmp     // int (KEY, KEY), returns 0 for equal keys
+//     #define CACHE_TMPL_GET u64_get     // VALUE (KEY), called on every miss
+//     #include "cache_tmpl.h"
+//
+// Generated API, where PREFIX_lfuda_* functions are the same as PREFIX_lfu_* plus PREFIX_lfuda_get_age and
+// PREFIX_lfuda_set_renormalize:
+//
+//     PREFIX_lfu_t *PREFIX_lfu_init(size_t size);
+//     void PREFIX_lfu_free(PREFIX_lfu_t *cache);
+//     VALUE *PREFIX_lfu_get(PREFIX_lfu_t *cache, KEY key);  // Pointer to the cached value
+//     size_t PREFIX_lfu_get_hits(PREFIX_lfu_t *cache);
+
+#ifndef LFUDA_CACHE_TMPL_H
+#define LFUDA_CACHE_TMPL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashmix.h"
+
+#define CACHE_TMPL_CONCAT_IMPL(prefix, name) prefix##_##name
+#define CACHE_TMPL_CONCAT(prefix, name)      CACHE_TMPL_CONCAT_IMPL(prefix, name)
+#define CACHE_TMPL_NAME(name)                CACHE_TMPL_CONCAT(CACHE_TMPL_PREFIX, name)
+
+// Age at which LFU-DA shifts its keys down by default, the same as for lfuda_t
+#define CACHE_TMPL_RENORMALIZE_DEFAULT (SIZE_MAX / 2)
+
+// Calloc memory and exit when there is none available
+static inline void *cache_tmpl_calloc(size_t count, size_t size) {
+    void *ptr = calloc(count, size);
+    if (!ptr) {
+        fprintf(stderr, "Memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+#endif
+
+#if !defined(CACHE_TMPL_PREFIX) || !defined(CACHE_TMPL_KEY) || !defined(CACHE_TMPL_VALUE) ||                           \
+    !defined(CACHE_TMPL_HASH) || !defined(CACHE_TMPL_CMP) || !defined(CACHE_TMPL_GET)
+#error "All of the CACHE_TMPL_* parameters must be defined before including cache_tmpl.h"
+#endif
+
+#define CT_NAME(name) CACHE_TMPL_NAME(name)
+#define CT_SLOT       CT_NAME(slot_t)
+#define CT_FREQ       CT_NAME(freq_t)
+#define CT_BASE       CT_NAME(base_t)
+
+//============================================================================================================
+
+// Entry of the cache. Local list links all the entries with the same key of the frequency node
+typedef struct CT_NAME(slot_s) {
+    struct CT_NAME(slot_s) *next, *prev;
+    struct CT_NAME(freq_s) *freq;
+    size_t frequency;
+    CACHE_TMPL_KEY key;
+    CACHE_TMPL_VALUE value;
+} CT_SLOT;
+
+// Frequency node with its local list
+typedef struct CT_NAME(freq_s) {
+    struct CT_NAME(freq_s) *next, *prev;
+    CT_SLOT *head, *tail;
+    size_t key;
+} CT_FREQ;
+
+//============================================================================================================
+
+// Open addressing hash table with linear probing and fixed size. Keys are stored inline, so that cmp does not
+// dereference the slot, and an empty bucket has slot equal to NULL. Hashes are mixed, so that weak hashes (e.g.
+// identity) spread over the low bits used by the mask
+typedef struct {
+    CACHE_TMPL_KEY key;
+    unsigned long hash;
+    CT_SLOT *slot;
+} CT_NAME(bucket_t);
+
+typedef struct {
+    CT_NAME(bucket_t) *array;
+    size_t mask;
+} CT_NAME(hashtab_t);
+
+static inline void CT_NAME(hashtab_init)(CT_NAME(hashtab_t) *table, size_t capacity) {
+    // Load factor is kept under 0.5 to keep the probe sequences short
+    size_t size = 1;
+    while (size < 2 * capacity) {
+        size <<= 1;
+    }
+
+    table->array = (CT_NAME(bucket_t) *)cache_tmpl_calloc(size, sizeof(CT_NAME(bucket_t)));
+    table->mask = size - 1;
+}
+
+static inline void CT_NAME(hashtab_free)(CT_NAME(hashtab_t) *table) {
+    free(table->array);
+}
+
+static inline CT_SLOT *CT_NAME(hashtab_lookup)(CT_NAME(hashtab_t) *table, CACHE_TMPL_KEY key) {
+    unsigned long hash = (unsigned long)hashmix_murmur(CACHE_TMPL_HASH(key));
+
+    for (size_t i = hash & table->mask; table->array[i].slot; i = (i + 1) & table->mask) {
+        if (table->array[i].hash == hash && CACHE_TMPL_CMP(table->array[i].key, key) == 0) {
+            return table->array[i].slot;
+        }
+    }
+
+    return NULL;
+}
+
+// Insert slot assuming that its key is not present and there is a free bucket
+static inline void CT_NAME(hashtab_insert)(CT_NAME(hashtab_t) *table, CT_SLOT *slot) {
+    unsigned long hash = (unsigned long)hashmix_murmur(CACHE_TMPL_HASH(slot->key));
+
+    size_t i = hash & table->mask;
+    while (table->array[i].slot) {
+        i = (i + 1) & table->mask;
+    }
+
+    table->array[i].key = slot->key;
+    table->array[i].hash = hash;
+    table->array[i].slot = slot;
+}
+
+// Remove key assuming it is present. Entries after it are shifted back, so that there are no tombstones
+static inline void CT_NAME(hashtab_remove)(CT_NAME(hashtab_t) *table, CACHE_TMPL_KEY key) {
+    unsigned long hash = (unsigned long)hashmix_murmur(CACHE_TMPL_HASH(key));
+
+    size_t i = hash & table->mask;
+    while (table->array[i].hash != hash || CACHE_TMPL_CMP(table->array[i].key, key) != 0) {
+        i = (i + 1) & table->mask;
+    }
+
+    for (size_t j = (i + 1) & table->mask; table->array[j].slot; j = (j + 1) & table->mask) {
+        size_t home = table->array[j].hash & table->mask;
+        // The entry can take the freed bucket only if the bucket is not before its home bucket
+        if (((j - home) & table->mask) >= ((j - i) & table->mask)) {
+            table->array[i] = table->array[j];
+            i = j;
+        }
+    }
+
+    table->array[i].slot = NULL;
+}
+
+//============================================================================================================
+
+// Storage and frequency list shared by both policies. There is a slot for every entry and a frequency node for every
+// distinct key, plus one, because a new frequency node is created before the old one is removed
+typedef struct {
+    CT_NAME(hashtab_t) table;
+
+    CT_SLOT *slots;
+    CT_FREQ *freqs;
+    CT_FREQ *freq_free; // Singly linked list of free frequency nodes
+
+    CT_FREQ *first, *last; // Frequency list in ascending order of keys
+
+    size_t size, curr_top, hits;
+} CT_BASE;
+
+static inline void CT_NAME(base_init)(CT_BASE *base, size_t size) {
+    CT_NAME(hashtab_init)(&base->table, size);
+
+    base->slots = (CT_SLOT *)cache_tmpl_calloc(size, sizeof(CT_SLOT));
+    base->freqs = (CT_FREQ *)cache_tmpl_calloc(size + 1, sizeof(CT_FREQ));
+    for (size_t i = 0; i < size; i++) {
+        base->freqs[i].next = &base->freqs[i + 1];
+    }
+    base->freq_free = base->freqs;
+
+    base->size = size;
+}
+
+static inline void CT_NAME(base_free)(CT_BASE *base) {
+    CT_NAME(hashtab_free)(&base->table);
+    free(base->slots);
+    free(base->freqs);
+}
+
+// Get a frequency node from the free list and insert it into the frequency list after prev, or at the front
+static inline CT_FREQ *CT_NAME(base_freq_init)(CT_BASE *base, CT_FREQ *prev, size_t key) {
+    CT_FREQ *node = base->freq_free;
+    base->freq_free = node->next;
+
+    memset(node, 0, sizeof(*node));
+    node->key = key;
+
+    node->prev = prev;
+    node->next = (prev ? prev->next : base->first);
+    *(node->prev ? &node->prev->next : &base->first) = node;
+    *(node->next ? &node->next->prev : &base->last) = node;
+
+    return node;
+}
+
+static inline void CT_NAME(base_freq_free)(CT_BASE *base, CT_FREQ *node) {
+    *(node->prev ? &node->prev->next : &base->first) = node->next;
+    *(node->next ? &node->next->prev : &base->last) = node->prev;
+
+    node->next = base->freq_free;
+    base->freq_free = node;
+}
+
+static inline void CT_NAME(base_local_push_front)(CT_FREQ *freq, CT_SLOT *slot) {
+    slot->freq = freq;
+    slot->prev = NULL;
+    slot->next = freq->head;
+    *(freq->head ? &freq->head->prev : &freq->tail) = slot;
+    freq->head = slot;
+}
+
+static inline void CT_NAME(base_local_remove)(CT_FREQ *freq, CT_SLOT *slot) {
+    *(slot->prev ? &slot->prev->next : &freq->head) = slot->next;
+    *(slot->next ? &slot->next->prev : &freq->tail) = slot->prev;
+}
+
+// Fill the slot for a new key and insert it into the hash table and the local list of freq
+static inline CACHE_TMPL_VALUE *CT_NAME(base_insert)(CT_BASE *base, CT_FREQ *freq, CT_SLOT *slot, CACHE_TMPL_KEY key) {
+    slot->key = key;
+    slot->frequency = 1;
+    slot->value = CACHE_TMPL_GET(key);
+
+    CT_NAME(base_local_push_front)(freq, slot);
+    CT_NAME(hashtab_insert)(&base->table, slot);
+
+    return &slot->value;
+}
+
+//============================================================================================================
+
+typedef struct {
+    CT_BASE base;
+} CT_NAME(lfu_t);
+
+// Returns the frequency node with key one greater than freqnode has, or with key 1 when freqnode is NULL
+static inline CT_FREQ *CT_NAME(lfu_next_freq)(CT_BASE *base, CT_FREQ *freqnode) {
+    size_t nextkey = (freqnode ? freqnode->key + 1 : 1);
+    CT_FREQ *next = (freqnode ? freqnode->next : base->first);
+
+    if (next && next->key == nextkey) {
+        return next;
+    }
+
+    return CT_NAME(base_freq_init)(base, freqnode, nextkey);
+}
+
+static inline void CT_NAME(lfu_remove_freq_if_empty)(CT_BASE *base, CT_FREQ *freqnode) {
+    if (!freqnode->head) {
+        CT_NAME(base_freq_free)(base, freqnode);
+    }
+}
+
+static inline CT_NAME(lfu_t) *CT_NAME(lfu_init)(size_t size) {
+    CT_NAME(lfu_t) *cache = (CT_NAME(lfu_t) *)cache_tmpl_calloc(1, sizeof(CT_NAME(lfu_t)));
+    CT_NAME(base_init)(&cache->base, size);
+    return cache;
+}
+
+static inline void CT_NAME(lfu_free)(CT_NAME(lfu_t) *cache) {
+    CT_NAME(base_free)(&cache->base);
+    free(cache);
+}
+
+static inline CACHE_TMPL_VALUE *CT_NAME(lfu_get)(CT_NAME(lfu_t) *cache, CACHE_TMPL_KEY key) {
+    CT_BASE *base = &cache->base;
+    CT_SLOT *slot = CT_NAME(hashtab_lookup)(&base->table, key);
+
+    // 1. There is already a cache entry, then we promote it to the frequency node with the next key
+    if (slot) {
+        CT_FREQ *root = slot->freq;
+
+        base->hits++;
+        slot->frequency++;
+
+        CT_NAME(base_local_remove)(root, slot);
+        CT_FREQ *next = CT_NAME(lfu_next_freq)(base, root);
+        CT_NAME(lfu_remove_freq_if_empty)(base, root);
+        CT_NAME(base_local_push_front)(next, slot);
+
+        return &slot->value;
+    }
+
+    // 2. The cache is not full, so the next free slot is taken
+    if (base->curr_top < base->size) {
+        slot = &base->slots[base->curr_top++];
+    }
+    // 3. The cache is full and the least recently used entry with the lowest frequency is evicted
+    else {
+        slot = base->first->tail;
+
+        CT_NAME(hashtab_remove)(&base->table, slot->key);
+        CT_NAME(base_local_remove)(base->first, slot);
+        CT_NAME(lfu_remove_freq_if_empty)(base, base->first);
+    }
+
+    return CT_NAME(base_insert)(base, CT_NAME(lfu_next_freq)(base, NULL), slot, key);
+}
+
+static inline size_t CT_NAME(lfu_get_hits)(CT_NAME(lfu_t) *cache) {
+    return cache->base.hits;
+}
+
+//============================================================================================================
+
+// LFU-DA finds frequency nodes in the same way as lfuda_t: keys only grow, so the node for a new key is found by walking
+// the frequency list forward from the current node of the entry or from the head, whichever is closer by key. When age
+// reaches the renormalisation threshold every key is shifted down together with age
+typedef struct {
+    CT_BASE base;
+    size_t age;
+    size_t renormalize;
+} CT_NAME(lfuda_t);
+
+// Returns the frequency node with key, creating it if there is none. The search starts after the node from, which must
+// have a smaller key, or from the head of the frequency list if from is NULL
+static inline CT_FREQ *CT_NAME(lfuda_freq_find_or_init)(CT_NAME(lfuda_t) *cache, CT_FREQ *from, size_t key) {
+    CT_FREQ *prev = from;
+    CT_FREQ *next = (from ? from->next : cache->base.first);
+
+    while (next && next->key < key) {
+        prev = next;
+        next = next->next;
+    }
+
+    if (next && next->key == key) {
+        return next;
+    }
+
+    return CT_NAME(base_freq_init)(&cache->base, prev, key);
+}
+
+static inline void CT_NAME(lfuda_remove_freq_if_empty)(CT_NAME(lfuda_t) *cache, CT_FREQ *freqnode) {
+    if (!freqnode->head) {
+        CT_NAME(base_freq_free)(&cache->base, freqnode);
+    }
+}
+
+// Set age to the key of the evicted entry. All keys are at least age, so when it gets too large they are shifted down
+// by age, which keeps the order of the nodes
+static inline void CT_NAME(lfuda_evicted_age)(CT_NAME(lfuda_t) *cache, size_t key) {
+    cache->age = key;
+
+    if (cache->renormalize && cache->age >= cache->renormalize) {
+        for (CT_FREQ *node = cache->base.first; node; node = node->next) {
+            node->key -= cache->age;
+        }
+        cache->age = 0;
+    }
+}
+
+static inline CT_NAME(lfuda_t) *CT_NAME(lfuda_init)(size_t size) {
+    CT_NAME(lfuda_t) *cache = (CT_NAME(lfuda_t) *)cache_tmpl_calloc(1, sizeof(CT_NAME(lfuda_t)));
+    CT_NAME(base_init)(&cache->base, size);
+    cache->renormalize = CACHE_TMPL_RENORMALIZE_DEFAULT;
+    return cache;
+}
+
+static inline void CT_NAME(lfuda_free)(CT_NAME(lfuda_t) *cache) {
+    CT_NAME(base_free)(&cache->base);
+    free(cache);
+}
+
+static inline CACHE_TMPL_VALUE *CT_NAME(lfuda_get)(CT_NAME(lfuda_t) *cache, CACHE_TMPL_KEY key) {
+    CT_BASE *base = &cache->base;
+    CT_SLOT *slot = CT_NAME(hashtab_lookup)(&base->table, key);
+
+    // 1. There is already a cache entry, then it moves to the frequency node with key frequency + age
+    if (slot) {
+        CT_FREQ *root = slot->freq;
+
+        base->hits++;
+        slot->frequency++;
+
+        // The next node is found while the current one is still in the list to start the search from
+        size_t nextkey = slot->frequency + cache->age;
+        CT_FREQ *from = (nextkey - cache->age < nextkey - root->key ? NULL : root);
+        CT_FREQ *next = CT_NAME(lfuda_freq_find_or_init)(cache, from, nextkey);
+
+        CT_NAME(base_local_remove)(root, slot);
+        CT_NAME(lfuda_remove_freq_if_empty)(cache, root);
+        CT_NAME(base_local_push_front)(next, slot);
+
+        return &slot->value;
+    }
+
+    // 2. The cache is not full, so the next free slot is taken
+    if (base->curr_top < base->size) {
+        slot = &base->slots[base->curr_top++];
+        CT_FREQ *freq = CT_NAME(lfuda_freq_find_or_init)(cache, NULL, cache->age + 1);
+        return CT_NAME(base_insert)(base, freq, slot, key);
+    }
+
+    // 3. The cache is full, the least recently used entry with the lowest key is evicted and its key becomes the age
+    CT_FREQ *first = base->first;
+    slot = first->tail;
+    CT_NAME(lfuda_evicted_age)(cache, first->key);
+
+    // All keys are at least age, so the node of the new entry is right after the head
+    CT_FREQ *freq = CT_NAME(lfuda_freq_find_or_init)(cache, NULL, cache->age + 1);
+
+    CT_NAME(hashtab_remove)(&base->table, slot->key);
+    CT_NAME(base_local_remove)(first, slot);
+    CT_NAME(lfuda_remove_freq_if_empty)(cache, first);
+
+    return CT_NAME(base_insert)(base, freq, slot, key);
+}
+
+static inline size_t CT_NAME(lfuda_get_hits)(CT_NAME(lfuda_t) *cache) {
+    return cache->base.hits;
+}
+
+static inline size_t CT_NAME(lfuda_get_age)(CT_NAME(lfuda_t) *cache) {
+    return cache->age;
+}
+
+// Set the age at which keys and age are shifted down to zero, 0 disables renormalisation
+static inline void CT_NAME(lfuda_set_renormalize)(CT_NAME(lfuda_t) *cache, size_t threshold) {
+    cache->renormalize = threshold;
+}
+
+//============================================================================================================
+
+#undef CT_NAME
+#undef CT_SLOT
+#undef CT_FREQ
+#undef CT_BASE
+
+#undef CACHE_TMPL_PREFIX
+#undef CACHE_TMPL_KEY
+#undef CACHE_TMPL_VALUE
+#undef CACHE_TMPL_HASH
+#undef CACHE_TMPL_CMP
+#undef CACHE_TMPL_GET
@@ -0,0 +1,63 @@
+#ifndef LFUDA_GDSF_CACHE_H
+#define LFUDA_GDSF_CACHE_H
+
+#include "cache.h"
+#include "dllist.h"
+#include "hashtab.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef void *gdsf_t;
+
+// Returns size of the page in bytes, which must not be 0
+typedef size_t (*gdsf_size_func_t)(void *index, void *page);
+// Returns cost of getting the page again after it is evicted
+typedef size_t (*gdsf_cost_func_t)(void *index, void *page);
+
+// Initializer struct for Greedy-Dual-Size-Frequency cache. Pages returned by cache.get are kept by pointer, so
+// cache.data_size must be 0, and the cache frees them with cache.free (if it is set) when they are evicted. cache.size
+// is the number of entries, for which memory is preallocated, and the cache grows past it if needed
+typedef struct {
+    cache_init_t cache;
+    // Capacity of the cache in bytes of the pages
+    size_t capacity;
+    gdsf_size_func_t size;
+    // Optional cost function, every page costs 1 if not set
+    gdsf_cost_func_t cost;
+} gdsf_init_t;
+
+#define GDSF_SIZE_F(func) ((gdsf_size_func_t)(func))
+#define GDSF_COST_F(func) ((gdsf_cost_func_t)(func))
+
+// Initialize cache
+gdsf_t gdsf_init(gdsf_init_t init);
+
+// Free cache together with the pages in it
+void gdsf_free(gdsf_t cache_);
+
+// Get page by index. Entries with the lowest priority age + frequency * cost / size are evicted until the page fits.
+// Pages larger than the capacity are returned without being cached
+void *gdsf_get(gdsf_t cache_, void *index);
+
+// Get current hits
+size_t gdsf_get_hits(gdsf_t cache_);
+
+// Get total size of the pages returned from the cache
+size_t gdsf_get_byte_hits(gdsf_t cache_);
+
+// Get total size of the pages in the cache
+size_t gdsf_get_used(gdsf_t cache_);
+
+// Get current age of cache. Age is relative, it drops back when the cache is renormalised
+size_t gdsf_get_age(gdsf_t cache_);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef LFUDA_HASHMIX_H
+#define LFUDA_HASHMIX_H
+
+#include <stddef.h>
+
+// Finalizer of 64-bit MurmurHash3. It is a bijection, so different hashes stay different after mixing. This is the only
+// mixer of the library: hash tables, the frequency sketch and the specialised caches of cache_tmpl.h all use it
+static inline unsigned long long hashmix_murmur(unsigned long long h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
+// Mapping of hashes to buckets shared by all hash table backends. By default the bucket is hash % size. With
+// HASHTAB_USE_POW2_SIZE table sizes are rounded up to powers of two, so that the division becomes a mask, and every
+// user hash is passed through a finalizer once, so that weak hashes (e.g. identity) still spread over the low bits
+
+#ifdef HASHTAB_USE_POW2_SIZE
+
+#define HASHTAB_POW2_SIZES 1
+
+static inline unsigned long hashtab_mix(unsigned long hash) {
+    return (unsigned long)hashmix_murmur(hash);
+}
+
+static inline size_t hashtab_bucket(unsigned long hash, size_t size) {
+    return hash & (size - 1);
+}
+
+// Round size up to the closest power of two
+static inline size_t hashtab_round_size(size_t size) {
+    size_t result = 1;
+    while (result < size) {
+        result <<= 1;
+    }
+    return result;
+}
+
+#else
+
+#define HASHTAB_POW2_SIZES 0
+
+static inline unsigned long hashtab_mix(unsigned long hash) {
+    return hash;
+}
+
+static inline size_t hashtab_bucket(unsigned long hash, size_t size) {
+    return hash % size;
+}
+
+static inline size_t hashtab_round_size(size_t size) {
+    return size;
+}
+
+#endif
+
+// Number of keys that are hashed and prefetched together by batched lookups
+#define HASHTAB_BATCH 16
+
+// Number of old buckets that are migrated on every insert, lookup and remove during an incremental resize. The table
+// grows at least twice, so the migration is over long before the new array reaches its load factor
+#define HASHTAB_MIGRATE_STEP 4
+
+#if defined(__GNUC__) || defined(__clang__)
+#define hashtab_prefetch(addr) __builtin_prefetch(addr)
+#else
+#define hashtab_prefetch(addr) ((void)(addr))
+#endif
+
+#endif
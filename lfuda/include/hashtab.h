@@ -1,6 +1,8 @@
 #ifndef LFUDA_HASHTAB_H
 #define LFUDA_HASHTAB_H
 
+#include "dllist.h"
+
 #ifdef __cplusplus
 #include <cstddef>
 extern "C" {
@@ -17,9 +19,22 @@ typedef unsigned long (*hash_func_t)(const void *);
 typedef int (*entry_cmp_func_t)(const void *, const void *);
 typedef void (*entry_free_func_t)(void *);
 
+// Hash table backends. Chaining keeps all entries in a single doubly linked list, while open addressing (Robin Hood
+// hashing) stores entries inline in the bucket array. The default one is chaining, unless the library is built with
+// HASHTAB_USE_OPEN_ADDRESSING
+typedef enum {
+    HASHTAB_DEFAULT = 0,
+    HASHTAB_CHAINING = 1,
+    HASHTAB_OPEN_ADDRESSING = 2,
+} hashtab_backend_t;
+
 // initialize hash table
 hashtab_t hashtab_init(size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp, entry_free_func_t freefunc);
 
+// initialize hash table with the specified backend
+hashtab_t hashtab_init_backend(hashtab_backend_t backend, size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp,
+                               entry_free_func_t freefunc);
+
 // change load factor from 0.7f in default
 void hashtab_set_load_factor(hashtab_t table_, float load_factor);
 
@@ -32,6 +47,8 @@ typedef struct {
     size_t used;       // Number of used buckets
     size_t collisions; // Number of collisions
     size_t inserts;    // Total number of elements in the hash table, including collisions
+    size_t migrated;   // Number of buckets already moved by the resize in progress
+    size_t migrating;  // Number of buckets to move by the resize in progress, 0 if there is none
 } hashtab_stat_t;
 
 hashtab_stat_t hashtab_get_stat(hashtab_t table_);
@@ -45,9 +62,17 @@ void hashtab_insert(hashtab_t *table_, void *entry);
 
 // Lookup whether the entry is alredy present in the table
 // Returns pointer to the entry, NULL if is absent
+// While an automatic resize is in progress, lookups move buckets to the new array as well, so they write to the table.
+// Tables that are looked up concurrently under a shared lock must have automatic resizing disabled
 void *hashtab_lookup(hashtab_t table_, const void *key);
 
+// Lookup a batch of keys, results[i] is the same as hashtab_lookup(table_, keys[i]) would return. All of the keys in a
+// batch are hashed and their buckets are prefetched before any of them is compared, so that cache misses overlap
+void hashtab_lookup_many(hashtab_t table_, const void **keys, void **results, size_t count);
+
 // Resize the table to accomodate max newsize buckets
+// Automatic resizes are incremental instead on both backends: the old bucket array is kept and a few of its buckets are
+// moved on every insert, lookup and remove, so that none of them pays for the whole table
 hashtab_t hashtab_resize(hashtab_t table_, size_t newsize);
 
 // Remove key from the table an return entry by pointer, NULL if it's absent from the table
@@ -56,6 +81,19 @@ void *hashtab_remove(hashtab_t table_, void *key);
 // Disable or enable automatic resizing
 void hashtab_set_enabled_resize(hashtab_t table_, int enabled);
 
+// Intrusive accessors for tables whose nodes are allocated by the user. Node data must point to the entry. Such a table
+// must have node ownership disabled, so that hashtab_free does not free the nodes
+void hashtab_set_owns_nodes(hashtab_t table_, int owns);
+
+// Create a node for hashtab_insert_node with data member pointing to entry. It is freed with dl_node_free
+dl_node_t hashtab_node_init(void *entry);
+
+// Insert node with an entry assuming it is not already present
+void hashtab_insert_node(hashtab_t *table_, dl_node_t node);
+
+// Unlink node with key from the table and return it without freeing, NULL if it's absent from the table
+dl_node_t hashtab_remove_node(hashtab_t table_, const void *key);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,8 +24,83 @@ void lfu_free(lfu_t cache_);
 // user
 void *lfu_get(lfu_t cache_, void *index);
 
+// Get page by index together with its length. For caches with cache_init_t.get_sized this is the length of the page,
+// otherwise it is data_size
+void *lfu_get_sized(lfu_t cache_, void *index, size_t *length);
+
+// Get page by index asynchronously, see cache_init_t.start_load. Hits call the callback with the page at once and
+// return 1. Misses return 0 and their callbacks are called when the load of the index is completed with
+// lfu_complete_load. The first miss of an index starts its load, and the page is inserted and evicts another entry only
+// at completion
+int lfu_get_async(lfu_t cache_, void *index, cache_callback_t callback, void *ctx);
+
+// Complete the load of index with its page. The page is copied into the cache and passed to the callbacks of all misses
+// that wait for it, in the order of the gets. Callbacks may get pages again, but must not complete other loads
+void lfu_complete_load(lfu_t cache_, void *index, void *page);
+
+// Insert index with page, which is copied into the cache, or overwrite the page of index if it is already there. Puts
+// take part in the policy like gets, so a new entry may evict another one and an existing one is promoted, but they are
+// not counted as hits. Pages of variable length are not supported. Returns whether index is in the cache afterwards,
+// which it is not when every other entry is pinned
+int lfu_put(lfu_t cache_, void *index, void *page);
+
+// Get page by index without promotion and without loading it, NULL if the index is not in the cache
+void *lfu_peek(lfu_t cache_, void *index);
+
+// Check whether index is in the cache without promotion
+int lfu_contains(lfu_t cache_, void *index);
+
+// Remove the entry of index, so that its slot is free for new entries. Returns whether there was such an entry, while
+// pinned entries are not removed and 0 is returned for them
+int lfu_erase(lfu_t cache_, void *index);
+
+// Get page by index and pin its entry, which is then never evicted and its page never moves until it has been unpinned
+// as many times as it has been pinned. Pinned entries are kept apart from the ones that can be evicted, so eviction
+// does not get slower with them. Hits of pinned entries are counted and raise their frequency, which the entry gets
+// back on the last unpin. Returns NULL if the page could not be inserted, because every other entry is pinned. Caches
+// without pages are not supported
+void *lfu_pin(lfu_t cache_, void *index);
+
+// Unpin the entry of index, which must be pinned. The last unpin looks for the frequency node of the entry starting
+// from the node it was pinned from, which is quick unless that node and the one before it have been freed in the
+// meantime. Then the search starts at the head and takes time linear in the number of distinct frequencies
+void lfu_unpin(lfu_t cache_, void *index);
+
+// Get number of misses whose pages were not inserted, because every entry of the cache was pinned. Such gets still
+// return the page of the loader, and NULL with cache_init_t.fill
+size_t lfu_get_rejected(lfu_t cache_);
+
+// Change the maximum number of entries of a cache of fixed size pages without losing its entries. Growing allocates
+// nothing at once: the pages of the new entries are allocated as they are inserted, and the hash table grows
+// incrementally with the inserts. Shrinking evicts nothing at once, instead every get, put, erase, pin and unpin evicts
+// a few more entries in the order of the policy until the cache fits, and gives back the slots and pages that are not
+// needed anymore. Pages beyond the initial capacity are freed, while the pages allocated at init are kept for later
+// entries. With read guards the pages are kept by the guards for later entries instead of being freed
+void lfu_set_capacity(lfu_t cache_, size_t size);
+
+// Do a single step of shrinking after the capacity has been reduced, which is what the requests of the cache do as
+// well. Returns whether there is more to evict or give back, so that an idle cache can be shrunk with
+// while (lfu_shrink(cache)). Entries that are pinned are not evicted, and shrinking stops at them
+int lfu_shrink(lfu_t cache_);
+
+// Start a read section of the cache with cache_init_t.read_guards and return its guard. Pages got after the start stay
+// valid until lfu_read_end, even when their entries are evicted, so they can be used without copying after the lock
+// of the cache is released. Gets still need the lock, while the read sections themselves are thread-safe
+size_t lfu_read_begin(lfu_t cache_);
+
+// Finish the read section of guard. Pages of evicted entries are reused only after all read sections that started
+// before their eviction have finished, so read sections should be short
+void lfu_read_end(lfu_t cache_, size_t guard);
+
+// Get pages for a batch of indices. Keys are looked up together with prefetching and then the gets are applied in
+// order, so results[i] and the state of the cache are the same as after lfu_get calls for every index one by one
+void lfu_get_many(lfu_t cache_, void **indices, void **results, size_t count);
+
 size_t lfu_get_hits(lfu_t cache_);
 
+// Get number of bytes taken by the pages of variable length in the slabs
+size_t lfu_get_used(lfu_t cache_);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,12 +23,94 @@ void lfuda_free(lfuda_t lfuda);
 // Get page by index
 void *lfuda_get(lfuda_t cache_, void *index);
 
+// Get page by index together with its length. For caches with cache_init_t.get_sized this is the length of the page,
+// otherwise it is data_size
+void *lfuda_get_sized(lfuda_t cache_, void *index, size_t *length);
+
+// Get page by index asynchronously, see cache_init_t.start_load. Hits call the callback with the page at once and
+// return 1. Misses return 0 and their callbacks are called when the load of the index is completed with
+// lfuda_complete_load. The first miss of an index starts its load, and the page is inserted and evicts another entry
+// only at completion
+int lfuda_get_async(lfuda_t cache_, void *index, cache_callback_t callback, void *ctx);
+
+// Complete the load of index with its page. The page is copied into the cache and passed to the callbacks of all misses
+// that wait for it, in the order of the gets. Callbacks may get pages again, but must not complete other loads
+void lfuda_complete_load(lfuda_t cache_, void *index, void *page);
+
+// Insert index with page, which is copied into the cache, or overwrite the page of index if it is already there. Puts
+// take part in the policy like gets, so a new entry may evict another one and an existing one is promoted, but they are
+// not counted as hits. Pages of variable length are not supported. Returns whether index is in the cache afterwards,
+// which it is not when every other entry is pinned
+int lfuda_put(lfuda_t cache_, void *index, void *page);
+
+// Get page by index without promotion and without loading it, NULL if the index is not in the cache
+void *lfuda_peek(lfuda_t cache_, void *index);
+
+// Check whether index is in the cache without promotion
+int lfuda_contains(lfuda_t cache_, void *index);
+
+// Remove the entry of index, so that its slot is free for new entries. Returns whether there was such an entry, while
+// pinned entries are not removed and 0 is returned for them
+int lfuda_erase(lfuda_t cache_, void *index);
+
+// Get page by index and pin its entry, which is then never evicted and its page never moves until it has been unpinned
+// as many times as it has been pinned. Pinned entries are kept apart from the ones that can be evicted, so eviction
+// does not get slower with them. Hits of pinned entries are counted and raise their frequency, which the entry gets
+// back on the last unpin. Returns NULL if the page could not be inserted, because every other entry is pinned. Caches
+// without pages are not supported
+void *lfuda_pin(lfuda_t cache_, void *index);
+
+// Unpin the entry of index, which must be pinned. The last unpin looks for the frequency node of the entry starting
+// from the node it was pinned from, which is quick unless that node and the one before it have been freed in the
+// meantime. Then the search starts at the head and takes time linear in the number of distinct frequencies
+void lfuda_unpin(lfuda_t cache_, void *index);
+
+// Get number of misses whose pages were not inserted, because every entry of the cache was pinned. Such gets still
+// return the page of the loader, and NULL with cache_init_t.fill
+size_t lfuda_get_rejected(lfuda_t cache_);
+
+// Change the maximum number of entries of a cache of fixed size pages without losing its entries. Growing allocates
+// nothing at once: the pages of the new entries are allocated as they are inserted, and the hash table grows
+// incrementally with the inserts. Shrinking evicts nothing at once, instead every get, put, erase, pin and unpin evicts
+// a few more entries in the order of the policy until the cache fits, and gives back the slots and pages that are not
+// needed anymore. Pages beyond the initial capacity are freed, while the pages allocated at init are kept for later
+// entries. With read guards the pages are kept by the guards for later entries instead of being freed
+void lfuda_set_capacity(lfuda_t cache_, size_t size);
+
+// Do a single step of shrinking after the capacity has been reduced, which is what the requests of the cache do as
+// well. Returns whether there is more to evict or give back, so that an idle cache can be shrunk with
+// while (lfuda_shrink(cache)). Entries that are pinned are not evicted, and shrinking stops at them
+int lfuda_shrink(lfuda_t cache_);
+
+// Start a read section of the cache with cache_init_t.read_guards and return its guard. Pages got after the start stay
+// valid until lfuda_read_end, even when their entries are evicted, so they can be used without copying after the lock
+// of the cache is released. Gets still need the lock, while the read sections themselves are thread-safe
+size_t lfuda_read_begin(lfuda_t cache_);
+
+// Finish the read section of guard. Pages of evicted entries are reused only after all read sections that started
+// before their eviction have finished, so read sections should be short
+void lfuda_read_end(lfuda_t cache_, size_t guard);
+
+// Get pages for a batch of indices. Keys are looked up together with prefetching and then the gets are applied in
+// order, so results[i] and the state of the cache are the same as after lfuda_get calls for every index one by one
+void lfuda_get_many(lfuda_t cache_, void **indices, void **results, size_t count);
+
 // Get current hits in lfuda
 size_t lfuda_get_hits(lfuda_t cache_);
 
-// Get current age of cache
+// Get number of bytes taken by the pages of variable length in the slabs
+size_t lfuda_get_used(lfuda_t cache_);
+
+// Get current age of cache. Age is relative, it drops back when the cache is renormalised
 size_t lfuda_get_age(lfuda_t cache_);
 
+// Set age of cache. Keys of all entries are shifted by the same amount, so the eviction order does not change
+void lfuda_set_age(lfuda_t cache_, size_t age);
+
+// Set the age at which keys and age are shifted down to zero, 0 disables renormalisation. By default it happens when
+// age reaches SIZE_MAX / 2
+void lfuda_set_renormalize(lfuda_t cache_, size_t threshold);
+
 #ifdef __cplusplus
 }
 #endif
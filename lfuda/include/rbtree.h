@@ -10,7 +10,8 @@ extern "C" {
 
 typedef void *rb_tree_t;
 
-// This is a distance function used for comparing elements and finding closest values
+// Comparator for elements, only the sign of the result is used. Don't return a difference of keys converted to int,
+// because it overflows for keys that differ by more than INT_MAX
 typedef int (*rb_cmp_func_t)(const void *, const void *);
 typedef const char *(rb_stringify_func_t)(const void *);
 
@@ -19,6 +20,9 @@ typedef void (*rb_free_func_t)(void *);
 // Initialize an empty red-black tree and return a handle
 rb_tree_t rb_tree_init(rb_cmp_func_t cmp);
 
+// Preallocate nodes, so that count more elements can be inserted without allocating memory
+void rb_tree_reserve(rb_tree_t tree_, size_t count);
+
 // Free the tree, when data_free != NULL call it for all node data
 void rb_tree_free(rb_tree_t tree_, rb_free_func_t data_free);
 
@@ -0,0 +1,53 @@
+#ifndef LFUDA_SHARDED_CACHE_H
+#define LFUDA_SHARDED_CACHE_H
+
+#include "cache.h"
+#include "dllist.h"
+#include "hashtab.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef void *sharded_t;
+
+// Initialize thread-safe cache of nshards independent LFU or LFU-DA caches with their own locks. Keys are routed to the
+// shards by init.hash and every shard holds its slice of init.size entries. Pages of variable length and loaders that
+// fill pages in place are not supported
+sharded_t lfu_sharded_init(cache_init_t init, size_t nshards);
+sharded_t lfuda_sharded_init(cache_init_t init, size_t nshards);
+
+// Free cache
+void sharded_free(sharded_t cache_);
+
+// Get page by index and copy its data_size bytes to page, which is returned. The page is copied while the shard is
+// locked, because other threads may evict the entry as soon as the lock is released. Indices that are not owned by the
+// cache (key_size is 0) must stay valid while they are in the cache, as with the caches of a single shard. Hits take
+// the shard lock only for reading, and the promotions of the entries are buffered and applied later in batches under
+// the write lock. When the buffers are full, promotions are dropped, so the policy is followed less exactly. Pages are
+// loaded outside of the shard lock. Only the first of the threads that miss the same index at the same time calls the
+// loader, while the others wait for it and get a copy of the same page. Every shard has a promotion buffer per online
+// CPU at init. With glibc the shard locks prefer writers, so that misses are not starved by hits. Elsewhere the
+// default read-write lock of the platform is used, which may prefer readers and delay misses under heavy hit traffic
+void *sharded_get(sharded_t cache_, void *index, void *page);
+
+// Get hits of all shards, including the ones with dropped promotions
+size_t sharded_get_hits(sharded_t cache_);
+
+// Get number of hits whose promotions have been dropped, because the buffers were full
+size_t sharded_get_dropped(sharded_t cache_);
+
+// Get number of misses that waited for the load of another thread instead of calling the loader
+size_t sharded_get_coalesced(sharded_t cache_);
+
+// Get the largest age of the shards, which is always 0 for LFU
+size_t sharded_get_age(sharded_t cache_);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
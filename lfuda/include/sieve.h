@@ -0,0 +1,45 @@
+#ifndef LFUDA_SIEVE_CACHE_H
+#define LFUDA_SIEVE_CACHE_H
+
+#include "cache.h"
+#include "dllist.h"
+#include "hashtab.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef void *sieve_t;
+
+// Initialize SIEVE cache. A hit only marks the entry as visited, so it is cheaper than with LFU or LFU-DA, which move
+// the entry to another frequency node
+sieve_t sieve_init(cache_init_t init);
+
+// Free cache
+void sieve_free(sieve_t cache_);
+
+// Get page by index
+void *sieve_get(sieve_t cache_, void *index);
+
+// Get page by index together with its length. For caches with cache_init_t.get_sized this is the length of the page,
+// otherwise it is data_size
+void *sieve_get_sized(sieve_t cache_, void *index, size_t *length);
+
+// Get pages for a batch of indices. Keys are looked up together with prefetching and then the gets are applied in
+// order, so results[i] and the state of the cache are the same as after sieve_get calls for every index one by one
+void sieve_get_many(sieve_t cache_, void **indices, void **results, size_t count);
+
+// Get current hits
+size_t sieve_get_hits(sieve_t cache_);
+
+// Get number of bytes taken by the pages of variable length in the slabs
+size_t sieve_get_used(sieve_t cache_);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
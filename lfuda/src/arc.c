@@ -0,0 +1,327 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "arc.h"
+#include "basecache.h"
+#include "clist.h"
+
+#include "memutil.h"
+#include <assert.h>
+#include <string.h>
+
+//============================================================================================================
+// Refer to "ARC: A Self-Tuning, Low Overhead Replacement Cache" by Megiddo and Modha for more information
+//
+// Resident entries are base cache slots in one of two LRU lists: T1 for the entries that have been requested once and
+// T2 for the ones requested at least twice. The lists are local lists of frequency nodes, which are not linked into the
+// frequency list. Ghost lists B1 and B2 remember keys evicted from T1 and T2. Ghosts have their own hash table and
+// store only the key, while the hash is kept in the hash table node and data of the list node points to the ghost list
+struct arc_s {
+    base_cache_t base;
+
+    freq_node_t t1, t2;
+    struct dl_list_s b1, b2;
+
+    hashtab_t ghost_table;
+    mempool_t *ghost_pool;
+
+    // Target size of T1
+    size_t target;
+};
+
+// Link must be the first member, so that the nodes of the ghost lists and ghosts are the same
+typedef struct {
+    struct dl_node_s link;
+    struct hashtab_node_s hash_link;
+    // Indices that are not owned by the cache are stored by pointer
+    void *index;
+    unsigned char key[];
+} arc_ghost_t;
+
+//============================================================================================================
+
+static inline size_t arc_list_len(dl_list_t list_) {
+    return ((struct dl_list_s *)list_)->len;
+}
+
+//============================================================================================================
+
+// Ghost hash table uses the same keys as the base cache, see base_cache_slot_key
+
+static inline const void *arc_ghost_key(struct arc_s *arc, arc_ghost_t *ghost) {
+    return (arc->base.key_size ? (const void *)ghost->key : (const void *)&ghost->index);
+}
+
+static inline arc_ghost_t *arc_ghost_of_key(struct arc_s *arc, void *found) {
+    if (!found) {
+        return NULL;
+    }
+
+    size_t offset = (arc->base.key_size ? offsetof(arc_ghost_t, key) : offsetof(arc_ghost_t, index));
+    return (arc_ghost_t *)((char *)found - offset);
+}
+
+//============================================================================================================
+
+arc_t arc_init(cache_init_t init) {
+    assert(!init.get_sized);
+    assert(!init.admission);
+    assert(!init.fill);
+
+    struct arc_s *arc = calloc_checked(1, sizeof(struct arc_s));
+
+    base_cache_init(&arc->base, init);
+
+    // T1 and T2 are never freed, so the pool is reserved for them on top of the frequency nodes of the entries
+    mempool_reserve(arc->base.freq_pool, init.size + 1 + 2);
+    arc->t1 = freq_node_init(arc->base.freq_pool, 1);
+    arc->t2 = freq_node_init(arc->base.freq_pool, 2);
+
+    // There are at most size ghosts, because |T1| + |B1| <= size and |T1| + |T2| + |B1| + |B2| <= 2 * size
+    arc->ghost_table = hashtab_init_backend(init.backend, init.size * 2, init.hash, init.cmp, NULL);
+    hashtab_set_owns_nodes(arc->ghost_table, 0);
+    hashtab_set_enabled_resize(arc->ghost_table, 0);
+    arc->ghost_pool = mempool_init(sizeof(arc_ghost_t) + init.key_size, init.size);
+
+    arc->target = 0;
+
+    return arc;
+}
+
+//============================================================================================================
+
+void arc_free(arc_t cache_) {
+    struct arc_s *arc = (struct arc_s *)cache_;
+
+    assert(arc);
+
+    hashtab_free(arc->ghost_table);
+    mempool_free(arc->ghost_pool);
+    base_cache_free(&arc->base);
+
+    free(arc);
+}
+
+//============================================================================================================
+
+// Remember the key of a resident entry at the head of the ghost list
+
+static void arc_ghost_insert(struct arc_s *arc, dl_list_t list, void *index) {
+    arc_ghost_t *ghost = mempool_alloc(arc->ghost_pool);
+
+    ghost->link.data = list;
+    if (arc->base.key_size) {
+        memcpy(ghost->key, index, arc->base.key_size);
+        ghost->hash_link.link.data = ghost->key;
+    } else {
+        ghost->index = index;
+        ghost->hash_link.link.data = &ghost->index;
+    }
+
+    dl_list_push_front(list, &ghost->link);
+    hashtab_insert_node(&arc->ghost_table, &ghost->hash_link.link);
+}
+
+//============================================================================================================
+
+static void arc_ghost_remove(struct arc_s *arc, arc_ghost_t *ghost) {
+    hashtab_remove_node(arc->ghost_table, arc_ghost_key(arc, ghost));
+    dl_list_remove(ghost->link.data, &ghost->link);
+    mempool_release(arc->ghost_pool, ghost);
+}
+
+//============================================================================================================
+
+// Evict the least recently used entry of a resident list and remember its key in the ghost list, unless ghost is NULL.
+// Returns the evicted node, whose slot and data are reused
+
+static local_node_t arc_evict(struct arc_s *arc, freq_node_t resident, dl_list_t ghost) {
+    base_cache_t *basecache = &arc->base;
+
+    local_list_t local_list = freq_node_get_local(resident);
+    local_node_t toevict = dl_list_get_last(local_list);
+    assert(toevict);
+
+    hashtab_remove_node(basecache->table, base_cache_slot_key(basecache, local_node_get_slot(toevict)));
+    dl_list_remove(local_list, toevict);
+
+    if (ghost) {
+        arc_ghost_insert(arc, ghost, local_node_get_data(toevict).index);
+    }
+
+    return toevict;
+}
+
+//============================================================================================================
+
+// REPLACE of the paper: evict from T1 if it is larger than the target, otherwise from T2
+
+static local_node_t arc_replace(struct arc_s *arc, int in_b2) {
+    size_t t1_len = arc_list_len(freq_node_get_local(arc->t1));
+
+    if (t1_len && ((in_b2 && t1_len == arc->target) || t1_len > arc->target)) {
+        return arc_evict(arc, arc->t1, &arc->b1);
+    }
+
+    return arc_evict(arc, arc->t2, &arc->b2);
+}
+
+//============================================================================================================
+
+static void *arc_get_case_found_impl(struct arc_s *arc, local_node_t found) {
+    base_cache_t *basecache = &arc->base;
+
+    basecache->hits += 1;
+
+    // Entry moves to the head of T2 from either of the resident lists
+    local_node_data_t local_data = local_node_get_data(found);
+    dl_list_remove(freq_node_get_local(local_data.root_node), found);
+    dl_list_push_front(freq_node_get_local(arc->t2), found);
+
+    local_data.frequency += 1;
+    local_data.root_node = arc->t2;
+    local_node_set_data(found, local_data);
+
+    return local_data.cached;
+}
+
+//============================================================================================================
+
+static void *arc_get_case_not_found_impl(struct arc_s *arc, void *index) {
+    base_cache_t *basecache = &arc->base;
+    size_t size = basecache->size;
+
+    void *page = base_cache_load(basecache, index);
+
+    void *ghost_key = hashtab_lookup(arc->ghost_table, (basecache->key_size ? index : (void *)&index));
+    arc_ghost_t *ghost = arc_ghost_of_key(arc, ghost_key);
+    size_t b1_len = arc_list_len(&arc->b1), b2_len = arc_list_len(&arc->b2);
+    size_t t1_len = arc_list_len(freq_node_get_local(arc->t1)), t2_len = arc_list_len(freq_node_get_local(arc->t2));
+
+    local_node_t toinsert = NULL;
+    freq_node_t resident = arc->t2;
+
+    // 1. Key has been evicted recently, so the list it was evicted from gets a larger target. There are ghosts, so the
+    // cache is full and a resident entry is replaced
+    if (ghost) {
+        int in_b2 = (ghost->link.data == &arc->b2);
+
+        if (!in_b2) {
+            size_t delta = (b2_len > b1_len ? b2_len / b1_len : 1);
+            arc->target = (arc->target + delta < size ? arc->target + delta : size);
+        } else {
+            size_t delta = (b1_len > b2_len ? b1_len / b2_len : 1);
+            arc->target = (arc->target > delta ? arc->target - delta : 0);
+        }
+
+        toinsert = arc_replace(arc, in_b2);
+        arc_ghost_remove(arc, ghost);
+    }
+
+    // 2. Key is new and goes to T1
+    else {
+        resident = arc->t1;
+
+        if (t1_len + b1_len == size) {
+            if (t1_len < size) {
+                arc_ghost_remove(arc, dl_list_get_last(&arc->b1));
+                toinsert = arc_replace(arc, 0);
+            } else {
+                toinsert = arc_evict(arc, arc->t1, NULL);
+            }
+        } else if (t1_len + t2_len + b1_len + b2_len >= size) {
+            if (t1_len + t2_len + b1_len + b2_len == 2 * size) {
+                arc_ghost_remove(arc, dl_list_get_last(&arc->b2));
+            }
+            // The cache is still filling up if there are no ghosts at all
+            if (t1_len + t2_len == size) {
+                toinsert = arc_replace(arc, 0);
+            }
+        }
+    }
+
+    char *curr_data_ptr = NULL;
+
+    if (toinsert) {
+        curr_data_ptr = base_cache_replace_page(basecache, local_node_get_data(toinsert).cached);
+    } else {
+        toinsert = base_cache_new_slot(basecache, &curr_data_ptr);
+    }
+
+    local_node_data_t local_data = {0};
+    local_data.frequency = 1;
+    local_data.index = index;
+    local_data.root_node = resident;
+    if (basecache->data_size) {
+        local_data.cached = curr_data_ptr;
+    }
+
+    base_cache_insert(basecache, resident, toinsert, local_data);
+
+    if (basecache->data_size) {
+        memcpy(curr_data_ptr, page, basecache->data_size);
+    }
+
+    return base_cache_miss_page(basecache, page, curr_data_ptr);
+}
+
+//============================================================================================================
+
+static void *arc_get_impl(base_cache_t *basecache, void *index, local_node_t found) {
+    // In this case strict-aliasing does not apply, because base_cache_t is the first member of arc_s struct
+    struct arc_s *arc = (struct arc_s *)basecache;
+
+    if (found) {
+        return arc_get_case_found_impl(arc, found);
+    }
+
+    return arc_get_case_not_found_impl(arc, index);
+}
+
+//============================================================================================================
+
+void *arc_get(arc_t cache_, void *index) {
+    struct arc_s *arc = (struct arc_s *)cache_;
+
+    assert(arc);
+    assert(index);
+
+    return arc_get_impl(&arc->base, index, base_cache_lookup(&arc->base, &index));
+}
+
+//============================================================================================================
+
+void arc_get_many(arc_t cache_, void **indices, void **results, size_t count) {
+    struct arc_s *arc = (struct arc_s *)cache_;
+
+    assert(arc);
+
+    base_cache_get_many(&arc->base, indices, results, count, arc_get_impl);
+}
+
+//============================================================================================================
+
+size_t arc_get_hits(arc_t cache_) {
+    // In this case strict-aliasing does not apply, because base_cache_t is the first member of arc_s struct
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->hits;
+}
+
+//============================================================================================================
+
+size_t arc_get_target(arc_t cache_) {
+    struct arc_s *arc = (struct arc_s *)cache_;
+
+    assert(arc);
+
+    return arc->target;
+}
@@ -21,6 +21,27 @@
 
 //============================================================================================================
 
+// Initial number of the pending asynchronous loads and their waiters
+#define BASE_CACHE_PENDING 64
+
+// Get of a miss that waits for the asynchronous load of its index
+typedef struct base_cache_waiter_s {
+    cache_callback_t callback;
+    void *ctx;
+    struct base_cache_waiter_s *next;
+} base_cache_waiter_t;
+
+// Asynchronous load, whose index is stored the same way as in the cache slots, see base_cache_slot_key
+typedef struct {
+    struct hashtab_node_s hash_link;
+    // Waiters are called in the order of the gets
+    base_cache_waiter_t *first, *last;
+    void *index;
+    unsigned char key[];
+} base_cache_pending_t;
+
+//============================================================================================================
+
 base_cache_t *base_cache_init(base_cache_t *cache, cache_init_t init) {
     assert(cache);
 
@@ -29,39 +50,322 @@ base_cache_t *base_cache_init(base_cache_t *cache, cache_init_t init) {
     assert(init.hash);
     assert(init.size);
 
-    // Either there should be a get function and non-zero data_size, or all must be NULL
-    assert((!init.get && !init.data_size) || (init.get && init.data_size));
+    // A get function needs non-zero data_size. Pages of fixed size can also be loaded only asynchronously, filled in
+    // place or only put into the cache
+    assert(!init.get || init.data_size);
+    assert(!init.fill || (!init.get && init.data_size));
+    // Asynchronous loads are supported for pages of fixed size only
+    assert(!init.start_load || !init.get_sized);
+    // Read guards protect pages of fixed size only
+    assert(!init.read_guards || (init.data_size && !init.get_sized));
+    // Pages are filled in place only by plain gets of LFU and LFU-DA
+    assert(!init.fill || (!init.get_sized && !init.start_load && !init.admission));
+    // Pages of variable length are got with their own loader and need a byte capacity
+    assert(!init.get_sized || (!init.get && init.capacity));
+    // Admission needs room for at least one entry besides the window and is not supported for pages of variable length
+    assert(!init.admission || (init.size >= 2 && !init.get_sized));
 
     cache->size = init.size;
     cache->data_size = init.data_size;
+    cache->key_size = init.key_size;
     cache->hits = 0;
     cache->slow_get = init.get;
     cache->cached_data = NULL;
-
-    cache->table = hashtab_init(init.size * 2, init.hash, init.cmp, free);
+    cache->sized_get = init.get_sized;
+    cache->slab = NULL;
+    cache->capacity = init.capacity;
+    cache->used = 0;
+
+    // Entries and hash table nodes are embedded into cache slots, which are freed together with the slot pool
+    cache->table = hashtab_init_backend(init.backend, init.size * 2, init.hash, init.cmp, NULL);
+    hashtab_set_owns_nodes(cache->table, 0);
     // Disable resize, because this would be bad for perfomance and totally redundant
     hashtab_set_enabled_resize(cache->table, 0);
 
-    cache->freq_list = dl_list_init();
+    memset(&cache->freq_list_head, 0, sizeof(cache->freq_list_head));
+    cache->freq_list = &cache->freq_list_head;
+
+    // There is a slot for every entry and a frequency node for every distinct key. One more frequency node is needed,
+    // because a new frequency node is created before the old one is removed. Fixed nodes that are never freed, the
+    // admission window and the node of pinned entries, are reserved on top of these
+    size_t fixed_freqs = 1 + (init.admission ? 1 : 0);
+    cache->slot_pool = mempool_init(sizeof(cache_slot_t) + init.key_size, init.size);
+    cache->freq_pool = mempool_init(sizeof(freq_node_storage_t), init.size + 1 + fixed_freqs);
 
     // If data_size == 0, then no data will get copied
     if (init.data_size) {
         cache->cached_data = calloc_checked(init.size, init.data_size);
     }
 
+    if (init.get_sized) {
+        cache->slab = slab_init();
+    }
+
+    cache->sketch = NULL;
+    cache->hash = init.hash;
+    cache->window = NULL;
+    cache->window_size = cache->window_used = 0;
+
+    // Window takes 1% of the cache, as with larger windows admission protects the frequent entries worse
+    if (init.admission) {
+        cache->sketch = sketch_init(init.size);
+        cache->window = freq_node_init(cache->freq_pool, 0);
+        cache->window_size = init.size / 100;
+        cache->window_size = (cache->window_size ? cache->window_size : 1);
+    }
+
+    cache->start_load = init.start_load;
+    cache->pending = NULL;
+    cache->pending_pool = cache->waiter_pool = NULL;
+    cache->completing = 0;
+    cache->completed_page = NULL;
+
+    cache->epoch = (init.read_guards ? epoch_init(init.data_size) : NULL);
+    cache->fill = init.fill;
+    cache->pinned = freq_node_init(cache->freq_pool, 0);
+    cache->rejected = 0;
+    memset(&cache->spares, 0, sizeof(cache->spares));
+    cache->fresh = cache->cached_data;
+    cache->fresh_count = (init.data_size ? init.size : 0);
+    cache->initial = cache->fresh_count;
+    cache->shrinking = 0;
+    cache->grown = 0;
+
+    // Loads are usually few compared to the entries, so the table of pending loads grows as needed
+    if (init.start_load) {
+        cache->pending = hashtab_init_backend(init.backend, BASE_CACHE_PENDING, init.hash, init.cmp, NULL);
+        hashtab_set_owns_nodes(cache->pending, 0);
+        cache->pending_pool = mempool_init(sizeof(base_cache_pending_t) + init.key_size, BASE_CACHE_PENDING);
+        cache->waiter_pool = mempool_init(sizeof(base_cache_waiter_t), BASE_CACHE_PENDING);
+    }
+
     return cache;
 }
 
 //============================================================================================================
 
-entry_t *entry_init(void *index, local_node_t local) {
-    entry_t *entry = calloc_checked(1, sizeof(entry_t));
-    assert(index);
+local_node_t base_cache_node_init(base_cache_t *cache) {
+    assert(cache);
+
+    cache_slot_t *slot = mempool_alloc(cache->slot_pool);
+
+    slot->local_link.data = &slot->local;
+    slot->hash_link.link.data = (cache->key_size ? (void *)slot->key : (void *)&slot->entry);
+    slot->entry.local = &slot->local_link;
+
+    return &slot->local_link;
+}
+
+//============================================================================================================
 
-    entry->index = index;
-    entry->local = local;
+local_node_t base_cache_new_slot(base_cache_t *cache, char **page) {
+    assert(cache);
+    assert(page);
+    assert(cache->curr_top < cache->size);
+
+    cache->curr_top += 1;
+
+    if (!dl_list_is_empty(&cache->spares)) {
+        local_node_t spare = dl_list_pop_front(&cache->spares);
+        *page = local_node_get_data(spare).cached;
+        return spare;
+    }
+
+    *page = cache->fresh;
+
+    // Pages of cached_data are taken first, then the entries of a grown cache get pages of their own
+    if (cache->data_size && cache->fresh_count) {
+        cache->fresh += cache->data_size;
+        cache->fresh_count -= 1;
+    } else if (cache->data_size && cache->epoch) {
+        *page = epoch_alloc(cache->epoch);
+    } else if (cache->data_size) {
+        *page = calloc_checked(1, cache->data_size);
+        cache->grown += 1;
+    }
+
+    return base_cache_node_init(cache);
+}
+
+//============================================================================================================
 
-    return entry;
+// Whether the page has been allocated on its own when the cache grew. With read guards such pages belong to the epoch
+static inline int base_cache_page_is_grown(base_cache_t *cache, char *page) {
+    uintptr_t begin = (uintptr_t)cache->cached_data, address = (uintptr_t)page;
+    uintptr_t end = begin + cache->initial * cache->data_size;
+    return (cache->data_size && !cache->epoch && (address < begin || address >= end));
+}
+
+//============================================================================================================
+
+// Whether the slot can be given back. Pages of cached_data can't be freed one by one, so their slots are kept
+static inline int base_cache_slot_can_drop(base_cache_t *cache, local_node_t node) {
+    return (!cache->data_size || cache->epoch || base_cache_page_is_grown(cache, local_node_get_data(node).cached));
+}
+
+//============================================================================================================
+
+// Give back a slot that is not in any list together with its page
+static void base_cache_drop_slot(base_cache_t *cache, local_node_t node) {
+    char *page = local_node_get_data(node).cached;
+
+    if (cache->data_size && cache->epoch) {
+        epoch_release(cache->epoch, page);
+    } else if (cache->data_size) {
+        free(page);
+        cache->grown -= 1;
+    }
+
+    mempool_release(cache->slot_pool, node);
+}
+
+//============================================================================================================
+
+void base_cache_release_slot(base_cache_t *cache, local_node_t node) {
+    assert(cache);
+    assert(node);
+    assert(!cache->slab);
+
+    cache->curr_top -= 1;
+
+    // The slot is not needed to fill the cache up to its capacity again
+    size_t available = cache->curr_top + cache->spares.len + cache->fresh_count;
+    if (available >= cache->size && base_cache_slot_can_drop(cache, node)) {
+        base_cache_drop_slot(cache, node);
+        return;
+    }
+
+    if (cache->epoch) {
+        local_node_data_t local_data = local_node_get_data(node);
+        local_data.cached = base_cache_replace_page(cache, local_data.cached);
+        local_node_set_data(node, local_data);
+    }
+
+    // Spares with grown pages are kept at the back, where shrinking gives them back from
+    if (base_cache_page_is_grown(cache, local_node_get_data(node).cached)) {
+        dl_list_push_back(&cache->spares, node);
+    } else {
+        dl_list_push_front(&cache->spares, node);
+    }
+}
+
+//============================================================================================================
+
+void base_cache_set_capacity(base_cache_t *cache, size_t size) {
+    assert(cache);
+    assert(size);
+    // Caches of pages of variable length are limited by their byte capacity instead
+    assert(!cache->slab);
+    // Admission needs room for at least one entry besides the window
+    assert(!cache->sketch || size >= 2);
+
+    // The hash table has been sized for the initial capacity, so from now on it grows incrementally with the inserts
+    if (size > cache->size) {
+        hashtab_set_enabled_resize(cache->table, 1);
+    }
+
+    // The window keeps its share of the cache. When it has to shrink, one entry leaves it on every miss
+    if (cache->sketch) {
+        cache->window_size = (size / 100 ? size / 100 : 1);
+    }
+
+    cache->shrinking |= (size < cache->size);
+    cache->size = size;
+}
+
+//============================================================================================================
+
+// Whether there is a spare slot that is not needed to fill the cache up to its capacity and can be given back
+static inline int base_cache_has_extra_spare(base_cache_t *cache) {
+    return (cache->curr_top + cache->spares.len + cache->fresh_count > cache->size && cache->spares.len &&
+            base_cache_slot_can_drop(cache, dl_list_get_last(&cache->spares)));
+}
+
+//============================================================================================================
+
+int base_cache_shrink(base_cache_t *cache, const base_cache_policy_t *policy) {
+    assert(cache);
+    assert(policy);
+
+    size_t step = 0;
+    int evictable = 1;
+
+    for (; step < BASE_CACHE_SHRINK_STEP && cache->curr_top > cache->size; step++) {
+        local_node_t victim = NULL;
+
+        // Entries of the window are evicted only when the rest of the cache is empty, and pinned entries never
+        if (!dl_list_is_empty(cache->freq_list)) {
+            freq_node_t first_freq = dl_list_get_first(cache->freq_list);
+            if (policy->evict) {
+                policy->evict(cache, freq_node_get_key(first_freq));
+            }
+            victim = dl_list_get_last(freq_node_get_local(first_freq));
+        } else if (cache->window && !dl_list_is_empty(freq_node_get_local(cache->window))) {
+            victim = dl_list_get_last(freq_node_get_local(cache->window));
+            cache->window_used -= 1;
+        } else {
+            evictable = 0;
+            break;
+        }
+
+        base_cache_remove(cache, victim);
+        base_cache_release_slot(cache, victim);
+    }
+
+    for (; step < BASE_CACHE_SHRINK_STEP && base_cache_has_extra_spare(cache); step++) {
+        base_cache_drop_slot(cache, dl_list_remove(&cache->spares, dl_list_get_last(&cache->spares)));
+    }
+
+    // Shrinking that is stopped by pinned entries goes on after they are unpinned
+    int extra_spare = base_cache_has_extra_spare(cache);
+    cache->shrinking = (cache->curr_top > cache->size || extra_spare);
+
+    return ((evictable && cache->curr_top > cache->size) || extra_spare);
+}
+
+//============================================================================================================
+
+void *base_cache_store(base_cache_t *cache, local_node_t node, void *page) {
+    assert(cache);
+    assert(node);
+
+    if (!cache->data_size) {
+        return page;
+    }
+
+    local_node_data_t local_data = local_node_get_data(node);
+
+    // Puts store their own pages in caches with fills as well
+    if (!cache->fill || cache->completing) {
+        memcpy(local_data.cached, page, cache->data_size);
+        return base_cache_miss_page(cache, page, local_data.cached);
+    }
+
+    if (!cache->fill(local_data.index, local_data.cached, cache->data_size)) {
+        return local_data.cached;
+    }
+
+    // The entry of the failed fill is removed, while its slot keeps the page for the next new entry
+    base_cache_remove(cache, node);
+    base_cache_release_slot(cache, node);
+
+    return NULL;
+}
+
+//============================================================================================================
+
+// Get local node of the hash table entry found by the key from base_cache_slot_key
+static inline local_node_t base_cache_found_node(base_cache_t *cache, void *found) {
+    if (!found) {
+        return NULL;
+    }
+
+    if (cache->key_size) {
+        cache_slot_t *slot = (cache_slot_t *)((char *)found - offsetof(cache_slot_t, key));
+        return &slot->local_link;
+    }
+
+    return ((entry_t *)found)->local;
 }
 
 //============================================================================================================
@@ -70,21 +374,238 @@ local_node_t base_cache_lookup(base_cache_t *cache, void **index) {
     assert(cache);
     assert(index);
 
-    entry_t *found = hashtab_lookup(cache->table, index);
+    void *found = hashtab_lookup(cache->table, (cache->key_size ? *index : (void *)index));
+
+    return base_cache_found_node(cache, found);
+}
+
+//============================================================================================================
+
+// Number of indices that are looked up together
+#define BASE_CACHE_BATCH 16
+
+void base_cache_lookup_many(base_cache_t *cache, void **indices, local_node_t *results, size_t count) {
+    assert(cache);
+    assert(indices);
+    assert(results);
+
+    // Hash table keys are the same as in base_cache_lookup
+    const void *keys[BASE_CACHE_BATCH];
+    void *found[BASE_CACHE_BATCH];
+
+    for (size_t start = 0; start < count; start += BASE_CACHE_BATCH) {
+        size_t batch = (count - start < BASE_CACHE_BATCH ? count - start : BASE_CACHE_BATCH);
+
+        for (size_t i = 0; i < batch; i++) {
+            keys[i] = (cache->key_size ? indices[start + i] : (void *)&indices[start + i]);
+        }
+
+        hashtab_lookup_many(cache->table, keys, found, batch);
+
+        for (size_t i = 0; i < batch; i++) {
+            results[start + i] = base_cache_found_node(cache, found[i]);
+        }
+    }
+}
+
+//============================================================================================================
+
+void base_cache_get_many(base_cache_t *cache, void **indices, void **results, size_t count, base_cache_get_func_t get) {
+    assert(cache);
+    assert(indices);
+    assert(results);
+    assert(get);
+
+    local_node_t found[BASE_CACHE_BATCH];
+
+    for (size_t start = 0; start < count; start += BASE_CACHE_BATCH) {
+        size_t batch = (count - start < BASE_CACHE_BATCH ? count - start : BASE_CACHE_BATCH);
+        base_cache_lookup_many(cache, indices + start, found, batch);
+
+        // Hits do not change the hash table, but a miss inserts an entry and may evict another one, and so does every
+        // get of a cache that is shrinking. After the first such get the rest of the batch is looked up again. The
+        // buckets are still in the cache after the prefetch
+        int changed = 0;
+        for (size_t i = 0; i < batch; i++) {
+            void *index = indices[start + i];
+            local_node_t node = (changed ? base_cache_lookup(cache, &index) : found[i]);
+
+            changed |= (node == NULL || base_cache_over_capacity(cache));
+            results[start + i] = get(cache, index, node);
+        }
+    }
+}
+
+//============================================================================================================
+
+static base_cache_pending_t *base_cache_find_pending(base_cache_t *cache, void *index) {
+    void *found = hashtab_lookup(cache->pending, (cache->key_size ? index : (void *)&index));
+
+    if (!found) {
+        return NULL;
+    }
+
+    size_t offset = (cache->key_size ? offsetof(base_cache_pending_t, key) : offsetof(base_cache_pending_t, index));
+    return (base_cache_pending_t *)((char *)found - offset);
+}
+
+//============================================================================================================
+
+int base_cache_get_async(base_cache_t *cache, void *index, cache_callback_t callback, void *ctx,
+                         base_cache_get_func_t get) {
+    assert(cache);
+    assert(cache->start_load);
+    assert(callback);
+    assert(get);
+
+    // 1. Hits complete at once
+    local_node_t found = base_cache_lookup(cache, &index);
+    if (found) {
+        callback(ctx, get(cache, index, found));
+        return 1;
+    }
+
+    // 2. Misses wait for the load of their index, which is started by the first one
+    base_cache_waiter_t *waiter = mempool_alloc(cache->waiter_pool);
+    waiter->callback = callback;
+    waiter->ctx = ctx;
+    waiter->next = NULL;
+
+    base_cache_pending_t *pending = base_cache_find_pending(cache, index);
+    if (pending) {
+        pending->last->next = waiter;
+        pending->last = waiter;
+        return 0;
+    }
+
+    pending = mempool_alloc(cache->pending_pool);
+    pending->first = pending->last = waiter;
+
+    if (cache->key_size) {
+        memcpy(pending->key, index, cache->key_size);
+        pending->hash_link.link.data = pending->key;
+        index = pending->key;
+    } else {
+        pending->index = index;
+        pending->hash_link.link.data = &pending->index;
+    }
+
+    hashtab_insert_node(&cache->pending, &pending->hash_link.link);
+
+    // Loader gets the copy of the index owned by the cache, which stays valid until the load is completed
+    cache->start_load(index);
+
+    return 0;
+}
+
+//============================================================================================================
+
+void base_cache_complete_load(base_cache_t *cache, void *index, void *page, base_cache_get_func_t get) {
+    assert(cache);
+    assert(cache->pending);
+    assert(get);
+
+    base_cache_pending_t *pending = base_cache_find_pending(cache, index);
+    assert(pending);
+
+    // 1. The load is removed first, so that the callbacks can get the same index again
+    hashtab_remove_node(cache->pending, pending->hash_link.link.data);
+    if (cache->key_size) {
+        index = pending->key;
+    }
+
+    // 2. The page is inserted as a miss, unless a synchronous get has inserted the index in the meantime
+    cache->completing = 1;
+    cache->completed_page = page;
+    void *cached = get(cache, index, base_cache_lookup(cache, &index));
+    cache->completing = 0;
+    cache->completed_page = NULL;
+
+    // 3. Every waiter gets the cached page
+    for (base_cache_waiter_t *waiter = pending->first, *next = NULL; waiter; waiter = next) {
+        next = waiter->next;
+        waiter->callback(waiter->ctx, cached);
+        mempool_release(cache->waiter_pool, waiter);
+    }
+
+    mempool_release(cache->pending_pool, pending);
+}
+
+//============================================================================================================
+
+int base_cache_put(base_cache_t *cache, void *index, void *page, base_cache_get_func_t get) {
+    assert(cache);
+    assert(!cache->slab);
+    assert(get);
+
+    local_node_t found = base_cache_lookup(cache, &index);
+
+    // Readers with guards may still read the old page, so the new one is written to another page. Pages of pinned
+    // entries stay where they are until they are unpinned, so they are overwritten in place
+    if (found && cache->data_size) {
+        local_node_data_t local_data = local_node_get_data(found);
+        if (!base_cache_is_pinned(cache, found)) {
+            local_data.cached = base_cache_replace_page(cache, local_data.cached);
+        }
+        memcpy(local_data.cached, page, cache->data_size);
+        local_node_set_data(found, local_data);
+    }
+
+    // Misses insert the page the same way as a completed load
+    size_t hits = cache->hits;
+    size_t rejected = cache->rejected;
+    cache->completing = 1;
+    cache->completed_page = page;
+    get(cache, index, found);
+    cache->completing = 0;
+    cache->completed_page = NULL;
+    cache->hits = hits;
+
+    return (cache->rejected == rejected);
+}
+
+//============================================================================================================
+
+void *base_cache_peek(base_cache_t *cache, void *index) {
+    assert(cache);
+
+    local_node_t found = base_cache_lookup(cache, &index);
+    return (found ? local_node_get_data(found).cached : NULL);
+}
+
+//============================================================================================================
+
+int base_cache_erase(base_cache_t *cache, void *index) {
+    assert(cache);
+
+    // Pinned entries are in use, so they stay
+    local_node_t found = base_cache_lookup(cache, &index);
+    if (!found || base_cache_is_pinned(cache, found)) {
+        return 0;
+    }
+
+    if (cache->slab) {
+        base_cache_evict_sized(cache, found);
+        return 1;
+    }
 
-    local_node_t *result = (found ? found->local : NULL);
+    if (base_cache_in_window(cache, found)) {
+        cache->window_used -= 1;
+    }
 
-    return result;
+    base_cache_remove(cache, found);
+    base_cache_release_slot(cache, found);
+    return 1;
 }
 
 //============================================================================================================
 
-entry_t *base_cache_remove(base_cache_t *cache, local_node_t node, void **index) {
+void base_cache_remove(base_cache_t *cache, local_node_t node) {
     assert(cache);
     assert(node);
 
-    // Index should correspond to the local node
-    entry_t *free_entry = hashtab_remove(cache->table, index);
+    cache_slot_t *slot = local_node_get_slot(node);
+    hashtab_remove_node(cache->table, base_cache_slot_key(cache, slot));
 
     freq_node_t freq_node = local_node_get_freq_node(node);
     local_list_t local_list = freq_node_get_local(freq_node);
@@ -92,19 +613,22 @@ entry_t *base_cache_remove(base_cache_t *cache, local_node_t node, void **index)
 
     // If list becomes empty, then free it and remove it
     base_cache_remove_freq_if_empty(cache, freq_node);
-
-    return free_entry;
 }
 
 //============================================================================================================
 
-void base_cache_insert(base_cache_t *cache, freq_node_t freqnode, local_node_t toinsert, local_node_data_t local_data,
-                       entry_t *free_entry) {
+void base_cache_insert(base_cache_t *cache, freq_node_t freqnode, local_node_t toinsert, local_node_data_t local_data) {
     assert(cache);
     assert(freqnode);
     assert(toinsert);
 
-    void *index = local_data.index;
+    cache_slot_t *slot = local_node_get_slot(toinsert);
+
+    // 0. Copy the index into the slot if the cache owns indices, from now on the copy is used
+    if (cache->key_size) {
+        memcpy(slot->key, local_data.index, cache->key_size);
+        local_data.index = slot->key;
+    }
 
     // 1. Set the root of toinsert to freqnode
     local_node_set_data(toinsert, local_data);
@@ -112,17 +636,310 @@ void base_cache_insert(base_cache_t *cache, freq_node_t freqnode, local_node_t t
     // 2. Insert the node the the local list
     dl_list_push_front(freq_node_get_local(freqnode), toinsert);
 
-    // 3. Create an entry and insert it into the hash table
-    entry_t *entry;
-    if (!free_entry) {
-        entry = entry_init(index, toinsert);
-    } else {
-        entry = free_entry;
-        entry->index = index;
-        entry->local = toinsert;
+    // 3. Set the entry of the slot and insert it into the hash table
+    slot->entry.index = local_data.index;
+    hashtab_insert_node(&cache->table, &slot->hash_link.link);
+}
+
+//============================================================================================================
+
+void base_cache_store_sized(base_cache_t *cache, local_node_data_t *local_data, void *page, size_t length) {
+    assert(cache);
+    assert(cache->slab);
+    assert(local_data);
+
+    local_data->cached = slab_alloc(cache->slab, length);
+    local_data->size = length;
+    cache->used += slab_class_size(length);
+
+    if (length) {
+        memcpy(local_data->cached, page, length);
     }
+}
 
-    hashtab_insert(&cache->table, entry);
+//============================================================================================================
+
+void base_cache_evict_sized(base_cache_t *cache, local_node_t node) {
+    assert(cache);
+    assert(cache->slab);
+    assert(node);
+
+    base_cache_remove(cache, node);
+    base_cache_release_sized(cache, node);
+}
+
+//============================================================================================================
+
+void base_cache_release_sized(base_cache_t *cache, local_node_t node) {
+    assert(cache);
+    assert(cache->slab);
+    assert(node);
+
+    local_node_data_t local_data = local_node_get_data(node);
+
+    slab_release(cache->slab, local_data.cached, local_data.size);
+    cache->used -= slab_class_size(local_data.size);
+
+    mempool_release(cache->slot_pool, node);
+    cache->curr_top -= 1;
+}
+
+//============================================================================================================
+
+// Hash of the index, which is the same as the hash table computes for it
+
+static inline unsigned long base_cache_hash(base_cache_t *cache, void **index) {
+    return cache->hash(cache->key_size ? *index : (void *)index);
+}
+
+//============================================================================================================
+
+void base_cache_record(base_cache_t *cache, void *index) {
+    assert(cache);
+    assert(cache->sketch);
+
+    sketch_increment(cache->sketch, base_cache_hash(cache, &index));
+}
+
+//============================================================================================================
+
+void *base_cache_pin(base_cache_t *cache, void *index, base_cache_get_func_t get) {
+    assert(cache);
+    assert(cache->data_size || cache->slab);
+    assert(get);
+
+    get(cache, index, base_cache_lookup(cache, &index));
+
+    // The index may be missing after the get, when it could not be inserted
+    local_node_t found = base_cache_lookup(cache, &index);
+    if (!found) {
+        return NULL;
+    }
+
+    cache_slot_t *slot = local_node_get_slot(found);
+
+    // The first pin takes the entry off the eviction lists
+    if (!slot->pins) {
+        if (base_cache_in_window(cache, found)) {
+            cache->window_used -= 1;
+        }
+
+        freq_node_t freq_node = local_node_get_freq_node(found);
+        dl_list_remove(freq_node_get_local(freq_node), found);
+
+        // Unpin starts at the node of the entry, or at the one before it when the node is freed now. Entries of the
+        // window are not in the frequency list, so their search starts at the head
+        slot->unpin_from = (freq_node == cache->window ? NULL : freq_node);
+        if (slot->unpin_from && dl_list_is_empty(freq_node_get_local(freq_node))) {
+            slot->unpin_from = dl_node_get_prev(freq_node);
+        }
+        base_cache_remove_freq_if_empty(cache, freq_node);
+
+        local_node_data_t local_data = local_node_get_data(found);
+        local_data.root_node = cache->pinned;
+        local_node_set_data(found, local_data);
+        dl_list_push_front(freq_node_get_local(cache->pinned), found);
+    }
+
+    slot->pins += 1;
+    return local_node_get_data(found).cached;
+}
+
+//============================================================================================================
+
+void base_cache_unpin(base_cache_t *cache, void *index, const base_cache_policy_t *policy) {
+    assert(cache);
+    assert(policy);
+
+    local_node_t found = base_cache_lookup(cache, &index);
+    assert(found);
+    assert(base_cache_is_pinned(cache, found));
+
+    cache_slot_t *slot = local_node_get_slot(found);
+    if (--slot->pins) {
+        return;
+    }
+
+    // The last unpin puts the entry back as if it had just been accessed with the frequency it has got so far
+    dl_list_remove(freq_node_get_local(cache->pinned), found);
+
+    local_node_data_t local_data = local_node_get_data(found);
+    // The node may have been freed while the entry was pinned and reused for another key, which the policy checks
+    freq_node_t from = slot->unpin_from;
+    from = (from && freq_node_is_live(from) ? from : NULL);
+    local_data.root_node = policy->find_freq(cache, from, local_data.frequency);
+    local_node_set_data(found, local_data);
+    dl_list_push_front(freq_node_get_local(local_data.root_node), found);
+}
+
+//============================================================================================================
+
+void *base_cache_pinned_hit(base_cache_t *cache, local_node_t node) {
+    assert(cache);
+    assert(base_cache_is_pinned(cache, node));
+
+    cache->hits += 1;
+
+    local_node_data_t local_data = local_node_get_data(node);
+    local_data.frequency += 1;
+    local_node_set_data(node, local_data);
+
+    return local_data.cached;
+}
+
+//============================================================================================================
+
+void *base_cache_window_hit(base_cache_t *cache, local_node_t node) {
+    assert(cache);
+    assert(base_cache_in_window(cache, node));
+
+    cache->hits += 1;
+
+    local_list_t window = freq_node_get_local(cache->window);
+    dl_list_remove(window, node);
+    dl_list_push_front(window, node);
+
+    return local_node_get_data(node).cached;
+}
+
+//============================================================================================================
+
+// Move the least recently used entry of the window to the cache
+
+static void base_cache_window_pop(base_cache_t *cache, const base_cache_policy_t *policy) {
+    local_list_t window = freq_node_get_local(cache->window);
+    local_node_t node = dl_list_remove(window, dl_list_get_last(window));
+
+    local_node_data_t local_data = local_node_get_data(node);
+    local_data.root_node = policy->first_freq(cache);
+    local_node_set_data(node, local_data);
+
+    dl_list_push_front(freq_node_get_local(local_data.root_node), node);
+}
+
+//============================================================================================================
+
+void *base_cache_admit_miss(base_cache_t *cache, void *index, const base_cache_policy_t *policy) {
+    assert(cache);
+    assert(cache->window);
+    assert(policy);
+
+    void *page = base_cache_load(cache, index);
+    local_list_t window = freq_node_get_local(cache->window);
+
+    local_node_t toinsert = NULL;
+    char *curr_data_ptr = NULL;
+
+    // 1. The cache is not full yet, so there is a free slot
+    if (cache->curr_top < cache->size) {
+        toinsert = base_cache_new_slot(cache, &curr_data_ptr);
+        cache->window_used += 1;
+    }
+
+    // 2. The cache and the window are full. The least recently used entry of the window competes with the victim of the
+    // cache, and the one that has been seen less often is evicted. The slot of the evicted entry is reused
+    else {
+        local_node_t candidate = dl_list_get_last(window);
+        freq_node_t first_freq = dl_list_get_first(cache->freq_list);
+        local_node_t victim = (first_freq ? dl_list_get_last(freq_node_get_local(first_freq)) : NULL);
+
+        // Pinned entries are neither in the window nor in the cache, so there may be nothing to evict
+        if (!candidate && !victim) {
+            return base_cache_reject(cache, page);
+        }
+
+        int evict_victim = !candidate;
+        if (candidate && victim) {
+            void *candidate_index = local_node_get_data(candidate).index;
+            void *victim_index = local_node_get_data(victim).index;
+
+            evict_victim = (sketch_estimate(cache->sketch, base_cache_hash(cache, &candidate_index)) >
+                            sketch_estimate(cache->sketch, base_cache_hash(cache, &victim_index)));
+        }
+
+        if (evict_victim) {
+            if (policy->evict) {
+                policy->evict(cache, freq_node_get_key(first_freq));
+            }
+            toinsert = victim;
+            base_cache_remove(cache, victim);
+
+            // The window keeps its size, unless all of its entries have been pinned
+            if (candidate) {
+                base_cache_window_pop(cache, policy);
+            } else {
+                cache->window_used += 1;
+            }
+        } else {
+            toinsert = candidate;
+            base_cache_remove(cache, candidate);
+        }
+
+        curr_data_ptr = base_cache_replace_page(cache, local_node_get_data(toinsert).cached);
+    }
+
+    local_node_data_t local_data = {0};
+    local_data.frequency = 1;
+    local_data.index = index;
+    local_data.root_node = cache->window;
+    if (cache->data_size) {
+        local_data.cached = curr_data_ptr;
+    }
+
+    base_cache_insert(cache, cache->window, toinsert, local_data);
+
+    // While the cache is filling up, entries that do not fit into the window move to the cache without competing
+    if (cache->window_used > cache->window_size) {
+        base_cache_window_pop(cache, policy);
+        cache->window_used -= 1;
+    }
+
+    if (cache->data_size) {
+        memcpy(curr_data_ptr, page, cache->data_size);
+    }
+
+    return base_cache_miss_page(cache, page, curr_data_ptr);
+}
+
+//============================================================================================================
+
+void base_cache_shift_keys(base_cache_t *cache, size_t oldbase, size_t newbase) {
+    assert(cache);
+
+    freq_node_t node = dl_list_get_first(cache->freq_list);
+    for (; node; node = dl_node_get_next(node)) {
+        freq_node_data_t data = freq_node_get_data(node);
+        // All keys are at least oldbase, so the difference can't underflow
+        assert(data.key >= oldbase);
+        assert(data.key - oldbase <= SIZE_MAX - newbase);
+        data.key = data.key - oldbase + newbase;
+        freq_node_set_data(node, data);
+    }
+}
+
+//============================================================================================================
+
+static void base_cache_free_grown_list(base_cache_t *cache, dl_list_t list) {
+    for (local_node_t node = dl_list_get_first(list); node; node = dl_node_get_next(node)) {
+        char *page = local_node_get_data(node).cached;
+        if (base_cache_page_is_grown(cache, page)) {
+            free(page);
+        }
+    }
+}
+
+// Free grown pages of all resident and spare slots
+static void base_cache_free_grown(base_cache_t *cache) {
+    for (freq_node_t node = dl_list_get_first(cache->freq_list); node; node = dl_node_get_next(node)) {
+        base_cache_free_grown_list(cache, freq_node_get_local(node));
+    }
+
+    if (cache->window) {
+        base_cache_free_grown_list(cache, freq_node_get_local(cache->window));
+    }
+
+    base_cache_free_grown_list(cache, freq_node_get_local(cache->pinned));
+    base_cache_free_grown_list(cache, &cache->spares);
 }
 
 //============================================================================================================
@@ -130,12 +947,31 @@ void base_cache_insert(base_cache_t *cache, freq_node_t freqnode, local_node_t t
 void base_cache_free(base_cache_t *cache) {
     assert(cache);
 
-    // 1. Free the hashtable
+    // 1. Free the hashtable and the grown pages, which only the slots know about
     hashtab_free(cache->table);
+    if (cache->grown) {
+        base_cache_free_grown(cache);
+    }
 
-    // 2. Free all lists
-    freq_list_free(cache->freq_list);
+    // 2. Free all slots and frequency nodes together with the lists they are linked into
+    mempool_free(cache->slot_pool);
+    mempool_free(cache->freq_pool);
 
     // 3. If there was any space allocated to the cached data, we free it
     free(cache->cached_data);
+    if (cache->slab) {
+        slab_free(cache->slab);
+    }
+    if (cache->sketch) {
+        sketch_free(cache->sketch);
+    }
+    // Loads that have not been completed are dropped together with their waiters
+    if (cache->pending) {
+        hashtab_free(cache->pending);
+        mempool_free(cache->pending_pool);
+        mempool_free(cache->waiter_pool);
+    }
+    if (cache->epoch) {
+        epoch_free(cache->epoch);
+    }
 }
\ No newline at end of file
@@ -6,7 +6,13 @@
 #include "hashtab.h"
 
 #include "clist.h"
+#include "epoch.h"
+#include "hashnode.h"
+#include "mempool.h"
+#include "sketch.h"
+#include "slab.h"
 #include <stddef.h>
+#include <stdint.h>
 
 // Base cache types private to the library files
 struct base_cache_s;
@@ -20,14 +26,69 @@ struct base_cache_s {
     hashtab_t table;
     freq_list_t freq_list;
 
+    // Pools for cache slots and frequency nodes preallocated for the capacity of the cache. Frequency list header is
+    // embedded as well, so that freeing the cache does not need to walk the lists
+    mempool_t *slot_pool;
+    mempool_t *freq_pool;
+    struct dl_list_s freq_list_head;
+
     size_t size;
     size_t data_size;
+    // Size of the indices owned by the cache, 0 if the indices are borrowed from the caller
+    size_t key_size;
 
     size_t hits;
     size_t curr_top;
 
     // For the time being this cache will support only entries of fixed size, which is fine at the moment
     char *cached_data;
+
+    // Pages of variable length are stored in the slab instead of cached_data, see cache_init_t.get_sized
+    cache_get_sized_page_t sized_get;
+    slab_t *slab;
+    size_t capacity;
+    size_t used;
+
+    // Admission, see cache_init_t.admission. Window is a frequency node that is not in the frequency list and its local
+    // list is the LRU window of new entries
+    sketch_t *sketch;
+    hash_func_t hash;
+    freq_node_t window;
+    size_t window_size;
+    size_t window_used;
+
+    // Asynchronous loads, see cache_init_t.start_load. While a load is completed, its page is inserted instead of the
+    // one from slow_get
+    cache_start_load_t start_load;
+    hashtab_t pending;
+    mempool_t *pending_pool;
+    mempool_t *waiter_pool;
+    int completing;
+    void *completed_page;
+
+    // Deferred reuse of the pages of evicted entries, see cache_init_t.read_guards. NULL without read guards
+    epoch_t *epoch;
+
+    // Loader that writes pages into the cache, see cache_init_t.fill
+    cache_fill_page_t fill;
+
+    // Slots of fixed size pages that have been freed by erases, shrinking or failed fills together with their pages.
+    // New entries take them before fresh pages, which no entry has had yet. Spares with grown pages are at the back
+    struct dl_list_s spares;
+    char *fresh;
+    size_t fresh_count;
+
+    // Number of pages in cached_data, which is allocated for the initial capacity. Entries beyond it get grown pages,
+    // which are allocated one by one and freed when the cache gives back their slots
+    size_t initial;
+    size_t grown;
+    // Whether shrinking after a reduction of the capacity has not finished yet, see base_cache_shrink
+    int shrinking;
+
+    // Pinned entries are kept in the local list of this frequency node, which is not in the frequency list, so that
+    // eviction never sees them. Misses that find nothing to evict are rejected
+    freq_node_t pinned;
+    size_t rejected;
 };
 
 // Data type that is stored in the hash table
@@ -36,19 +97,234 @@ typedef struct {
     local_node_t local;
 } entry_t;
 
+// Everything a resident entry needs is allocated at once: links into the local list and into the hash table chain,
+// local node data and the hash table entry. Local link must be the first member, so that local node and slot are the
+// same. Indices owned by the cache are stored inline after the slot
+typedef struct {
+    struct dl_node_s local_link;
+    struct hashtab_node_s hash_link;
+    local_node_data_t local;
+    entry_t entry;
+    // Number of pins of the entry, see base_cache_pin
+    size_t pins;
+    // Frequency node near the one the entry was pinned from, where unpin starts to look for its node. NULL for the head
+    freq_node_t unpin_from;
+    unsigned char key[];
+} cache_slot_t;
+
+static inline cache_slot_t *local_node_get_slot(local_node_t node_) {
+    assert(node_);
+    return (cache_slot_t *)node_;
+}
+
+// Hash table key of the slot. Borrowed indices are stored in the table as entries, which are looked up by pointer to
+// the index, while indices owned by the cache are stored and looked up by pointer to the index itself
+static inline const void *base_cache_slot_key(base_cache_t *cache, cache_slot_t *slot) {
+    assert(cache);
+    assert(slot);
+    return (cache->key_size ? (const void *)slot->key : (const void *)&slot->entry.index);
+}
+
 // Accepts ptr to a base_cache member in derived classes and returns it
 base_cache_t *base_cache_init(base_cache_t *cache, cache_init_t init);
 void base_cache_free(base_cache_t *cache);
 
+// Allocates a slot for a new entry and returns its local node
+local_node_t base_cache_node_init(base_cache_t *cache);
+
+// Takes a free slot for a new entry while the cache is not full and stores its page in *page. This is a spare slot if
+// there is one, or the next unused slot otherwise
+local_node_t base_cache_new_slot(base_cache_t *cache, char **page);
+
+// Keeps the slot of a removed entry of fixed size pages as a spare one together with its page. With read guards the
+// page is retired and the slot gets another one. Slots that are not needed to fill the cache up to its capacity are
+// given back instead, except for the ones with pages of cached_data, see base_cache_shrink
+void base_cache_release_slot(base_cache_t *cache, local_node_t node);
+
+// Sets the maximum number of entries. Growing allocates nothing at once: pages of the new entries are allocated when
+// they are inserted, and the hash table grows incrementally. Shrinking evicts nothing by itself, see base_cache_shrink
+void base_cache_set_capacity(base_cache_t *cache, size_t size);
+
 // Gets local node with index
 local_node_t base_cache_lookup(base_cache_t *cache, void **index);
 
-// Removes local node from cache and returns it
-entry_t *base_cache_remove(base_cache_t *cache, local_node_t node, void **index);
+// Gets local nodes for a batch of indices with prefetching, results[i] is the same as base_cache_lookup would return
+void base_cache_lookup_many(base_cache_t *cache, void **indices, local_node_t *results, size_t count);
+
+// Handles a single get of a policy, found is the local node with index or NULL if it is absent
+typedef void *(*base_cache_get_func_t)(base_cache_t *cache, void *index, local_node_t found);
+
+// Gets a batch of indices by calling get for them in order, results are the same as for a sequence of single gets
+void base_cache_get_many(base_cache_t *cache, void **indices, void **results, size_t count, base_cache_get_func_t get);
+
+// Returns whether a miss has a page to insert. Caches of fixed size pages without a loader only get pages from puts
+static inline int base_cache_can_load(base_cache_t *cache) {
+    assert(cache);
+    return (cache->completing || cache->slow_get || cache->fill || !cache->data_size);
+}
+
+// Page for the miss of index, which is the page of the load that is being completed, or the page from slow_get
+static inline void *base_cache_load(base_cache_t *cache, void *index) {
+    assert(cache);
+
+    if (cache->completing) {
+        return cache->completed_page;
+    }
+
+    // Caches without a loader can't load pages for synchronous gets, while fills load them later
+    assert(cache->slow_get || cache->fill || !cache->data_size);
+
+    return (cache->slow_get ? cache->slow_get(index) : NULL);
+}
+
+// Page that a miss returns when every entry is pinned, so that nothing can be evicted for it. Caches that fill pages
+// in place have no page to return, so the miss gets NULL
+static inline void *base_cache_reject(base_cache_t *cache, void *page) {
+    assert(cache);
+    cache->rejected += 1;
+    return page;
+}
+
+// Page for the entry that replaces an evicted one. Without read guards it is the page of the evicted entry, otherwise
+// that page is retired until no reader can use it
+static inline char *base_cache_replace_page(base_cache_t *cache, char *evicted) {
+    assert(cache);
+    return (cache->epoch ? epoch_replace(cache->epoch, evicted) : evicted);
+}
+
+// Page that a miss returns. With read guards it is the copy in the cache, which the guards protect, instead of the page
+// of the loader
+static inline void *base_cache_miss_page(base_cache_t *cache, void *page, char *cached) {
+    assert(cache);
+    return (cache->epoch ? cached : page);
+}
+
+// Stores the page of a new entry, which has already been inserted as node, and returns the page for the miss. With
+// cache_init_t.fill the page is filled in place, and when that fails the entry is removed and NULL is returned
+void *base_cache_store(base_cache_t *cache, local_node_t node, void *page);
+
+// Inserts index with page or overwrites the page of its entry. New entries are inserted by get as misses, while
+// existing ones are promoted by get as hits, which are not counted. Returns whether the index is in the cache
+int base_cache_put(base_cache_t *cache, void *index, void *page, base_cache_get_func_t get);
+
+// Page of index without promotion, or NULL if the index is not in the cache
+void *base_cache_peek(base_cache_t *cache, void *index);
+
+// Removes the entry of index and frees its slot for new entries. Returns whether there was such an entry
+int base_cache_erase(base_cache_t *cache, void *index);
+
+// Asynchronous get of index, see cache_init_t.start_load. Hits call the callback before returning 1, while misses wait
+// for the load of index and return 0
+int base_cache_get_async(base_cache_t *cache, void *index, cache_callback_t callback, void *ctx,
+                         base_cache_get_func_t get);
+
+// Inserts the page of the load of index with get and passes the cached page to the callbacks of the misses
+void base_cache_complete_load(base_cache_t *cache, void *index, void *page, base_cache_get_func_t get);
+
+// Removes local node from the hash table and its local list. The node can then be reused for another index
+void base_cache_remove(base_cache_t *cache, local_node_t node);
 
 // Inserts toinsert at freqnode (at head)
-void base_cache_insert(base_cache_t *cache, freq_node_t freqnode, local_node_t toinsert, local_node_data_t local_data,
-                       entry_t *free_entry);
+void base_cache_insert(base_cache_t *cache, freq_node_t freqnode, local_node_t toinsert, local_node_data_t local_data);
+
+// Returns whether the entry for a page of length bytes can't be inserted without evicting another one first. Pages of
+// variable length need room both for a slot and in the byte capacity
+static inline int base_cache_is_full(base_cache_t *cache, size_t length) {
+    assert(cache);
+
+    if (cache->curr_top >= cache->size) {
+        return 1;
+    }
+
+    return (cache->slab && cache->used + slab_class_size(length) > cache->capacity);
+}
+
+// Returns whether a page of length bytes fits into the empty cache
+static inline int base_cache_fits(base_cache_t *cache, size_t length) {
+    assert(cache);
+    return (!cache->slab || slab_class_size(length) <= cache->capacity);
+}
+
+// Copies the page of length bytes into the slab and sets cached and size of local_data
+void base_cache_store_sized(base_cache_t *cache, local_node_data_t *local_data, void *page, size_t length);
+
+// Removes local node like base_cache_remove and frees its slot together with the page in the slab
+void base_cache_evict_sized(base_cache_t *cache, local_node_t node);
+
+// Frees the slot of a local node that is not in the cache anymore together with its page in the slab
+void base_cache_release_sized(base_cache_t *cache, local_node_t node);
+
+// Policy specific steps of the base cache. Admission moves entries into the cache with first_freq and evicts them with
+// evict, which shrinking uses as well, and the last unpin puts an entry back into the cache with find_freq
+typedef struct {
+    // Returns the frequency node for an entry that moves from the window to the cache
+    freq_node_t (*first_freq)(base_cache_t *cache);
+    // Optional, called with the key of the victim of the cache before it is evicted
+    void (*evict)(base_cache_t *cache, size_t key);
+    // Returns the frequency node for an entry with frequency that is put back into the cache after pinning. The search
+    // may start at from, a live node of the frequency list, or at the head if from is NULL or its key is too large
+    freq_node_t (*find_freq)(base_cache_t *cache, freq_node_t from, size_t frequency);
+} base_cache_policy_t;
+
+// Number of entries evicted by a single base_cache_shrink, so that shrinking by many entries does not stall any request
+#define BASE_CACHE_SHRINK_STEP 8
+
+// Evicts at most BASE_CACHE_SHRINK_STEP entries in the order of the policy while there are more entries than size, and
+// then gives back at most as many spare slots that are not needed to fill the cache up to size. Slots are released to
+// the pool, grown pages are freed, and with read guards pages are retired to be reused by later entries. Pages of
+// cached_data stay as spares. Returns whether there is more to evict or give back, which is 0 as well when all of the
+// entries over size are pinned
+int base_cache_shrink(base_cache_t *cache, const base_cache_policy_t *policy);
+
+// Whether shrinking has not finished since the capacity was reduced, so that base_cache_shrink is worth calling. Spare
+// slots with pages of cached_data are kept, so counting the slots would not tell when it has finished
+static inline int base_cache_over_capacity(base_cache_t *cache) {
+    assert(cache);
+    return cache->shrinking;
+}
+
+// Count an access to index in the admission sketch
+void base_cache_record(base_cache_t *cache, void *index);
+
+// Returns whether the local node is in the admission window
+static inline int base_cache_in_window(base_cache_t *cache, local_node_t node) {
+    assert(cache);
+    assert(node);
+    return (cache->window && local_node_get_freq_node(node) == cache->window);
+}
+
+// Handles a hit of an entry in the admission window, which just moves to the head of the window
+void *base_cache_window_hit(base_cache_t *cache, local_node_t node);
+
+// Returns whether the local node is pinned
+static inline int base_cache_is_pinned(base_cache_t *cache, local_node_t node) {
+    assert(cache);
+    assert(node);
+    return (local_node_get_freq_node(node) == cache->pinned);
+}
+
+// Gets index with get and pins its entry, which is then kept off the eviction lists until it is unpinned as many
+// times. Returns the page in the cache, or NULL if the index could not be inserted
+void *base_cache_pin(base_cache_t *cache, void *index, base_cache_get_func_t get);
+
+// Unpins the entry of index, which the last unpin puts back into the frequency node from policy->find_freq. The search
+// starts at the node the entry was pinned from, or at its predecessor if that node was freed, so it is short when the
+// list has changed little while the entry was pinned. When that node has been freed as well, the search starts at the
+// head and takes time linear in the number of distinct keys
+void base_cache_unpin(base_cache_t *cache, void *index, const base_cache_policy_t *policy);
+
+// Handles a hit of a pinned entry, which only counts the access
+void *base_cache_pinned_hit(base_cache_t *cache, local_node_t node);
+
+// Handles a miss with admission, inserting index into the window and deciding which entry is evicted
+void *base_cache_admit_miss(base_cache_t *cache, void *index, const base_cache_policy_t *policy);
+
+// Age at which dynamic aging policies shift their keys down by default, so that age + priority never overflows
+#define BASE_CACHE_RENORMALIZE_DEFAULT (SIZE_MAX / 2)
+
+// Shift keys of all frequency nodes by newbase - oldbase, the order of the nodes is kept. All keys must be at least
+// oldbase
+void base_cache_shift_keys(base_cache_t *cache, size_t oldbase, size_t newbase);
 
 static inline void base_cache_remove_freq_if_empty(base_cache_t *cache, freq_node_t node) {
     assert(cache);
@@ -56,9 +332,9 @@ static inline void base_cache_remove_freq_if_empty(base_cache_t *cache, freq_nod
 
     local_list_t local_list = freq_node_get_local(node);
 
-    if (dl_list_is_empty(local_list)) {
-        dl_list_free(local_list, NULL);
-        freq_node_free(dl_list_remove(cache->freq_list, node));
+    // Admission window and pinned entries stay even when they are empty
+    if (node != cache->window && node != cache->pinned && dl_list_is_empty(local_list)) {
+        freq_node_free(cache->freq_pool, dl_list_remove(cache->freq_list, node));
     }
 }
 
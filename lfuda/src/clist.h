@@ -5,12 +5,13 @@
 
 #include "cache.h"
 #include "dllist.h"
+#include "dlnode.h"
 #include "hashtab.h"
+#include "mempool.h"
 #include <assert.h>
 #include <stddef.h>
 #include <string.h>
 
-#include "memutil.h"
 
 //============================================================================================================
 
@@ -30,24 +31,15 @@ typedef struct {
     void *cached;
     void *index;
     freq_node_t root_node;
+    // Size in bytes and cost of fetching the cached data, only used by policies that weigh entries
+    size_t size;
+    size_t cost;
 } local_node_data_t;
 
 //============================================================================================================
 
 // Utility functions for working with frequency and local lists
 
-// Init local node with pointer to a root node and fam data with pointer to cached data
-static inline local_node_t local_node_init(local_node_data_t data) {
-    local_node_data_t *data_ptr = calloc_checked(1, sizeof(local_node_data_t));
-    freq_node_t node = dl_node_init(data_ptr);
-
-    *data_ptr = data;
-
-    return node;
-}
-
-//============================================================================================================
-
 typedef struct {
     local_list_t local_list;
     size_t key;
@@ -55,15 +47,24 @@ typedef struct {
 
 //============================================================================================================
 
-// Initialize frequency node with key
-static inline freq_node_t freq_node_init(size_t key) {
-    freq_node_data_t *data = calloc_checked(1, sizeof(freq_node_data_t));
-    freq_node_t node = dl_node_init(data);
+// Frequency node, its data and its local list are allocated as a single pool object. Link must be the first member
+typedef struct {
+    struct dl_node_s link;
+    freq_node_data_t data;
+    struct dl_list_s local;
+} freq_node_storage_t;
+
+// Initialize frequency node with key from the pool of freq_node_storage_t objects
+static inline freq_node_t freq_node_init(mempool_t *pool, size_t key) {
+    assert(pool);
 
-    data->local_list = dl_list_init();
-    data->key = key;
+    freq_node_storage_t *storage = mempool_alloc(pool);
 
-    return node;
+    storage->link.data = &storage->data;
+    storage->data.local_list = &storage->local;
+    storage->data.key = key;
+
+    return &storage->link;
 }
 
 //============================================================================================================
@@ -138,54 +139,24 @@ static inline void local_node_set_freq_node(local_node_t node_, freq_node_t freq
 
 //============================================================================================================
 
-static void local_node_free_data(void *data_) {
-    local_node_data_t *data = (local_node_data_t *)data_;
-    assert(data);
-    free(data);
-}
-
-//============================================================================================================
-
-static void local_list_free(local_list_t list_) {
-    assert(list_);
-    dl_list_free(list_, local_node_free_data);
-}
-
-//============================================================================================================
-
-static void freq_node_free(freq_node_t node_) {
+// Return frequency node back to the pool. Its local list is embedded into the node and must be empty. The node is
+// marked as freed, so that stale pointers to it can be told apart from live nodes, see freq_node_is_live
+static inline void freq_node_free(mempool_t *pool, freq_node_t node_) {
+    assert(pool);
     assert(node_);
-    freq_node_data_t *data = (freq_node_data_t *)dl_node_get_data(node_);
-    free(data);
-    free(node_);
-}
-
-//============================================================================================================
+    assert(dl_list_is_empty(freq_node_get_local(node_)));
 
-static void freq_node_free_data(void *data_) {
-    freq_node_data_t *data = (freq_node_data_t *)data_;
-    assert(data);
-
-    assert(data->local_list);
-    local_list_free(data->local_list);
-
-    free(data);
+    ((freq_node_storage_t *)node_)->data.local_list = NULL;
+    mempool_release(pool, node_);
 }
 
 //============================================================================================================
 
-static void local_node_free(local_node_t node_) {
+// Whether a frequency node of a pool of freq_node_storage_t objects is allocated. The pool links freed objects only
+// through their first word and never frees its chunks, so stale pointers to nodes can still be checked
+static inline int freq_node_is_live(freq_node_t node_) {
     assert(node_);
-    local_node_data_t *data = (local_node_data_t *)dl_node_get_data(node_);
-    free(data);
-    free(node_);
-}
-
-//============================================================================================================
-
-static void freq_list_free(freq_list_t list_) {
-    assert(list_);
-    dl_list_free(list_, freq_node_free_data);
+    return (((freq_node_storage_t *)node_)->data.local_list != NULL);
 }
 
 //============================================================================================================
@@ -8,6 +8,7 @@
  */
 
 #include "dllist.h"
+#include "dlnode.h"
 #include "error.h"
 #include "memutil.h"
 
@@ -15,14 +16,6 @@
 #include <stddef.h>
 #include <string.h>
 
-//============================================================================================================
-struct dl_node_s {
-    struct dl_node_s *next, *prev;
-    void *data;
-    // Flexible array member for storing data
-    char fam[];
-};
-
 //============================================================================================================
 
 dl_node_t dl_node_init(void *data) {
@@ -37,9 +30,10 @@ dl_node_t dl_node_init_fam(void *data, size_t size, void *fam_data) {
     assert(fam_data);
     assert(size);
 
+    // Fam data is stored right after the node, so that struct dl_node_s itself stays embeddable into other structs
     struct dl_node_s *node = calloc_checked(1, sizeof(struct dl_node_s) + size * sizeof(char));
     node->data = data;
-    memcpy(node->fam, fam_data, size * sizeof(char));
+    memcpy(node + 1, fam_data, size * sizeof(char));
 
     return node;
 }
@@ -50,7 +44,7 @@ dl_node_t dl_node_init_fam(void *data, size_t size, void *fam_data) {
 void *dl_node_get_fam(dl_node_t node_) {
     struct dl_node_s *node = (struct dl_node_s *)node_;
     assert(node);
-    return &(node->fam);
+    return node + 1;
 }
 
 //============================================================================================================
@@ -94,12 +88,6 @@ dl_node_t dl_node_get_prev(dl_node_t node_) {
     return node->prev;
 }
 
-//============================================================================================================
-struct dl_list_s {
-    struct dl_node_s *head, *tail;
-    size_t len;
-};
-
 //============================================================================================================
 
 dl_list_t dl_list_init() {
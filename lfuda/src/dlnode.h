@@ -0,0 +1,18 @@
+#ifndef LFUDA_DLNODE_H
+#define LFUDA_DLNODE_H
+
+#include <stddef.h>
+
+// Layout of the doubly linked list and its node. It is private to the library and exposed only so that other containers
+// can embed nodes and lists intrusively instead of allocating each one separately. A zeroed list is a valid empty list
+struct dl_node_s {
+    struct dl_node_s *next, *prev;
+    void *data;
+};
+
+struct dl_list_s {
+    struct dl_node_s *head, *tail;
+    size_t len;
+};
+
+#endif
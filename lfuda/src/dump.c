@@ -13,7 +13,6 @@
 #include "dllist.h"
 #include "lfuda.h"
 
-#include "memutil.h"
 #include <assert.h>
 #include <stdio.h>
 
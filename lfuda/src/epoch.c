@@ -0,0 +1,241 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "epoch.h"
+
+#include "memutil.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+//============================================================================================================
+
+// Readers that can be in their read sections at the same time without waiting for each other. Every reader has its own
+// cache line, so that readers of different threads do not invalidate each other's lines
+#define EPOCH_READERS 128
+#define EPOCH_LINE    64
+
+// Retired pages are kept in a ring buffer, which starts at this capacity and grows as needed
+#define EPOCH_RETIRED_INITIAL 64
+
+typedef struct {
+    _Alignas(EPOCH_LINE) atomic_size_t epoch;
+} epoch_reader_t;
+
+typedef struct {
+    char *page;
+    size_t epoch;
+} epoch_retired_t;
+
+struct epoch_s {
+    // Epoch of every reader in its read section, 0 when the reader slot is free
+    epoch_reader_t readers[EPOCH_READERS];
+
+    // Epoch of the next retirement, which starts at 1. Written only by the thread that modifies the cache
+    _Alignas(EPOCH_LINE) atomic_size_t global;
+    size_t data_size;
+
+    // Retired pages in the order of their epochs
+    epoch_retired_t *retired;
+    size_t retired_first;
+    size_t retired_count;
+    size_t retired_capacity;
+
+    // Pages that can be reused
+    char **reusable;
+    size_t reusable_count;
+    size_t reusable_capacity;
+
+    // Pages allocated in addition to the pages of the cache, which are freed together with the reclamation
+    char **owned;
+    size_t owned_count;
+    size_t owned_capacity;
+};
+
+// Reader slot where the read sections of the thread start looking for a free one
+static atomic_size_t epoch_threads = 0;
+static _Thread_local size_t epoch_hint = SIZE_MAX;
+
+//============================================================================================================
+
+// Grow array of capacity elements of size bytes twice, if it is full
+static void *epoch_reserve(void *array, size_t count, size_t *capacity, size_t size) {
+    if (count < *capacity) {
+        return array;
+    }
+
+    size_t grown = (*capacity ? *capacity * 2 : EPOCH_RETIRED_INITIAL);
+    void *result = realloc(array, grown * size);
+    if (!result) {
+        ERROR("Memory exhausted\n");
+    }
+
+    *capacity = grown;
+    return result;
+}
+
+//============================================================================================================
+
+epoch_t *epoch_init(size_t data_size) {
+    assert(data_size);
+
+    // Reader slots are aligned to the cache line, which calloc does not guarantee
+    struct epoch_s *epoch = aligned_alloc(EPOCH_LINE, sizeof(struct epoch_s));
+    if (!epoch) {
+        ERROR("Memory exhausted\n");
+    }
+
+    for (size_t i = 0; i < EPOCH_READERS; i++) {
+        atomic_init(&epoch->readers[i].epoch, 0);
+    }
+
+    atomic_init(&epoch->global, 1);
+    epoch->data_size = data_size;
+
+    epoch->retired = NULL;
+    epoch->retired_first = epoch->retired_count = epoch->retired_capacity = 0;
+    epoch->reusable = NULL;
+    epoch->reusable_count = epoch->reusable_capacity = 0;
+    epoch->owned = NULL;
+    epoch->owned_count = epoch->owned_capacity = 0;
+
+    return epoch;
+}
+
+//============================================================================================================
+
+void epoch_free(epoch_t *epoch) {
+    assert(epoch);
+
+    for (size_t i = 0; i < epoch->owned_count; i++) {
+        free(epoch->owned[i]);
+    }
+
+    free(epoch->owned);
+    free(epoch->reusable);
+    free(epoch->retired);
+    free(epoch);
+}
+
+//============================================================================================================
+
+size_t epoch_read_begin(epoch_t *epoch) {
+    assert(epoch);
+
+    if (epoch_hint == SIZE_MAX) {
+        epoch_hint = atomic_fetch_add(&epoch_threads, 1) % EPOCH_READERS;
+    }
+
+    // The reader may announce an epoch that has already passed, which only delays the reuse of some pages. Pages it
+    // gets after the announcement are retired later, so they are not reused before the read section ends
+    size_t now = atomic_load(&epoch->global);
+
+    // When all reader slots are taken, wait for one of them to become free
+    for (size_t guard = epoch_hint;; guard = (guard + 1) % EPOCH_READERS) {
+        size_t expected = 0;
+        if (atomic_compare_exchange_weak(&epoch->readers[guard].epoch, &expected, now)) {
+            return guard;
+        }
+    }
+}
+
+//============================================================================================================
+
+void epoch_read_end(epoch_t *epoch, size_t guard) {
+    assert(epoch);
+    assert(guard < EPOCH_READERS);
+    assert(atomic_load_explicit(&epoch->readers[guard].epoch, memory_order_relaxed));
+
+    atomic_store_explicit(&epoch->readers[guard].epoch, 0, memory_order_release);
+}
+
+//============================================================================================================
+
+// Move the retired pages that no reader can use anymore to the reusable ones. Pages are retired in the order of their
+// epochs, so only the oldest ones need to be checked
+static void epoch_reclaim(struct epoch_s *epoch) {
+    size_t oldest = SIZE_MAX;
+    for (size_t i = 0; i < EPOCH_READERS; i++) {
+        size_t reader = atomic_load_explicit(&epoch->readers[i].epoch, memory_order_acquire);
+        if (reader && reader < oldest) {
+            oldest = reader;
+        }
+    }
+
+    while (epoch->retired_count && epoch->retired[epoch->retired_first].epoch < oldest) {
+        epoch->reusable = epoch_reserve(epoch->reusable, epoch->reusable_count, &epoch->reusable_capacity,
+                                        sizeof(char *));
+        epoch->reusable[epoch->reusable_count++] = epoch->retired[epoch->retired_first].page;
+
+        epoch->retired_first = (epoch->retired_first + 1) % epoch->retired_capacity;
+        epoch->retired_count -= 1;
+    }
+}
+
+//============================================================================================================
+
+// Append page to the ring buffer of retired pages, which is unrolled when it grows
+static void epoch_retire(struct epoch_s *epoch, char *page, size_t now) {
+    if (epoch->retired_count == epoch->retired_capacity) {
+        size_t capacity = epoch->retired_capacity;
+        epoch->retired = epoch_reserve(epoch->retired, epoch->retired_count, &epoch->retired_capacity,
+                                       sizeof(epoch_retired_t));
+
+        // Elements that were at the beginning of the old buffer follow the ones at its end
+        for (size_t i = 0; i < epoch->retired_first; i++) {
+            epoch->retired[capacity + i] = epoch->retired[i];
+        }
+    }
+
+    epoch_retired_t retired = {page, now};
+    epoch->retired[(epoch->retired_first + epoch->retired_count) % epoch->retired_capacity] = retired;
+    epoch->retired_count += 1;
+}
+
+//============================================================================================================
+
+void epoch_release(epoch_t *epoch, char *retired) {
+    assert(epoch);
+    assert(retired);
+
+    // Readers that start after this can't get the retired page anymore, because it has been removed from the cache
+    size_t now = atomic_load_explicit(&epoch->global, memory_order_relaxed);
+    epoch_retire(epoch, retired, now);
+    atomic_store(&epoch->global, now + 1);
+}
+
+//============================================================================================================
+
+char *epoch_alloc(epoch_t *epoch) {
+    assert(epoch);
+
+    if (!epoch->reusable_count) {
+        epoch_reclaim(epoch);
+    }
+
+    if (epoch->reusable_count) {
+        return epoch->reusable[--epoch->reusable_count];
+    }
+
+    // Every retired page may still be read, so the cache grows by one page
+    char *page = calloc_checked(1, epoch->data_size);
+    epoch->owned = epoch_reserve(epoch->owned, epoch->owned_count, &epoch->owned_capacity, sizeof(char *));
+    epoch->owned[epoch->owned_count++] = page;
+
+    return page;
+}
+
+//============================================================================================================
+
+char *epoch_replace(epoch_t *epoch, char *retired) {
+    epoch_release(epoch, retired);
+    return epoch_alloc(epoch);
+}
@@ -0,0 +1,34 @@
+#ifndef LFUDA_EPOCH_H
+#define LFUDA_EPOCH_H
+
+#include <stddef.h>
+
+// Epoch-based reclamation of the pages of a cache. Readers announce the epoch in which they start to use pages, and the
+// page of an evicted entry is retired with the current epoch instead of being overwritten by the next miss. Retired
+// pages are reused only when every reader that started before their retirement has finished. Until then new entries
+// get other pages, which are allocated when there are no reusable ones
+struct epoch_s;
+typedef struct epoch_s epoch_t;
+
+// Create reclamation of pages of data_size bytes
+epoch_t *epoch_init(size_t data_size);
+
+void epoch_free(epoch_t *epoch);
+
+// Start a read section and return its guard. Safe to call from any thread at any time
+size_t epoch_read_begin(epoch_t *epoch);
+
+// Finish the read section of guard. Safe to call from any thread at any time
+void epoch_read_end(epoch_t *epoch, size_t guard);
+
+// Retire the page of an evicted entry and return the page for the entry that replaces it. Must be called by one thread
+// at a time, which is the one that modifies the cache, the same as the two functions below
+char *epoch_replace(epoch_t *epoch, char *retired);
+
+// Retire the page of an entry that nothing replaces, such as one evicted by shrinking
+void epoch_release(epoch_t *epoch, char *retired);
+
+// Return a page for an entry that replaces nothing, which is a reusable retired page or a newly allocated one
+char *epoch_alloc(epoch_t *epoch);
+
+#endif
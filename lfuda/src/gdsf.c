@@ -0,0 +1,345 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "gdsf.h"
+#include "basecache.h"
+#include "clist.h"
+#include "rbtree.h"
+
+#include "memutil.h"
+#include <assert.h>
+
+//============================================================================================================
+// Greedy-Dual-Size-Frequency works the same way as LFU-DA, but the key of an entry is age + frequency * cost / size and
+// the capacity is counted in bytes. Keys of different entries are no longer close to each other, so frequency nodes are
+// found with a red-black tree of their keys instead of walking the frequency list
+struct gdsf_s {
+    base_cache_t base;
+    // Tree of pointers to the keys of the frequency nodes
+    rb_tree_t rbtree;
+
+    cache_get_page_t get;
+    entry_free_func_t free_page;
+    gdsf_size_func_t size;
+    gdsf_cost_func_t cost;
+
+    size_t capacity;
+    size_t used;
+    size_t byte_hits;
+    size_t age;
+};
+
+// Priorities are fixed point numbers, so that pages of a few megabytes with cost 1 are still ordered by frequency
+#define GDSF_PRIORITY_SCALE ((size_t)1 << 24)
+// Priorities are capped, so that age + priority never overflows before the cache is renormalised
+#define GDSF_PRIORITY_MAX (SIZE_MAX / 4)
+
+//============================================================================================================
+
+// Returns frequency * cost / size in fixed point
+
+static size_t gdsf_priority(size_t frequency, size_t cost, size_t size) {
+    assert(size);
+    assert(size <= SIZE_MAX / GDSF_PRIORITY_SCALE);
+
+    if (cost && frequency > GDSF_PRIORITY_MAX / cost) {
+        return GDSF_PRIORITY_MAX;
+    }
+
+    size_t value = frequency * cost;
+    size_t whole = value / size, rest = value % size;
+
+    if (whole >= GDSF_PRIORITY_MAX / GDSF_PRIORITY_SCALE) {
+        return GDSF_PRIORITY_MAX;
+    }
+
+    return whole * GDSF_PRIORITY_SCALE + rest * GDSF_PRIORITY_SCALE / size;
+}
+
+//============================================================================================================
+
+static int gdsf_key_cmp(const size_t *key1, const size_t *key2) {
+    assert(key1);
+    assert(key2);
+    return (*key1 > *key2) - (*key1 < *key2);
+}
+
+//============================================================================================================
+
+// Pointer to the key of the frequency node, which is stored in the tree
+
+static size_t *gdsf_freq_node_key(freq_node_t node_) {
+    assert(node_);
+    freq_node_data_t *data = (freq_node_data_t *)dl_node_get_data(node_);
+    return &data->key;
+}
+
+//============================================================================================================
+
+// Frequency node, whose key is pointed to by key
+
+static freq_node_t gdsf_key_freq_node(const size_t *key) {
+    assert(key);
+    freq_node_storage_t *storage = (freq_node_storage_t *)((char *)key - offsetof(freq_node_storage_t, data.key));
+    return &storage->link;
+}
+
+//============================================================================================================
+
+// Returns the freq node with key, creating it and inserting it into the red black tree if there is none
+
+static freq_node_t gdsf_freq_node_find_or_init(struct gdsf_s *gdsf, size_t key) {
+    assert(gdsf);
+
+    base_cache_t *basecache = &gdsf->base;
+
+    const size_t *closest = rb_tree_closest_left(gdsf->rbtree, &key);
+
+    if (closest && *closest == key) {
+        return gdsf_key_freq_node(closest);
+    }
+
+    freq_node_t new_freq_node = freq_node_init(basecache->freq_pool, key);
+    rb_tree_insert(gdsf->rbtree, gdsf_freq_node_key(new_freq_node));
+
+    if (!closest) {
+        dl_list_push_front(basecache->freq_list, new_freq_node);
+    } else {
+        dl_list_insert_after(basecache->freq_list, gdsf_key_freq_node(closest), new_freq_node);
+    }
+
+    return new_freq_node;
+}
+
+//============================================================================================================
+
+// Remove freq node from the freq list and from the red black tree if local list of this freq node is empty
+
+static void gdsf_remove_freq_if_empty(struct gdsf_s *gdsf, freq_node_t node) {
+    assert(gdsf);
+    assert(node);
+
+    if (dl_list_is_empty(freq_node_get_local(node))) {
+        rb_tree_remove(gdsf->rbtree, gdsf_freq_node_key(node));
+        freq_node_free(gdsf->base.freq_pool, dl_list_remove(gdsf->base.freq_list, node));
+    }
+}
+
+//============================================================================================================
+
+gdsf_t gdsf_init(gdsf_init_t init) {
+    assert(init.cache.get);
+    assert(init.size);
+    assert(init.capacity);
+    // Pages are kept by pointer, because they differ in size
+    assert(!init.cache.data_size);
+
+    struct gdsf_s *gdsf = calloc_checked(1, sizeof(struct gdsf_s));
+
+    // Base cache only stores the entries, the pages are got and freed here
+    cache_init_t baseinit = init.cache;
+    baseinit.get = NULL;
+    base_cache_init(&gdsf->base, baseinit);
+    // Number of entries is not known in advance, so the table has to grow with them
+    hashtab_set_enabled_resize(gdsf->base.table, 1);
+
+    gdsf->rbtree = rb_tree_init(RBTREE_CMP_F(gdsf_key_cmp));
+    rb_tree_reserve(gdsf->rbtree, init.cache.size + 1);
+
+    gdsf->get = init.cache.get;
+    gdsf->free_page = init.cache.free;
+    gdsf->size = init.size;
+    gdsf->cost = init.cost;
+    gdsf->capacity = init.capacity;
+
+    return gdsf;
+}
+
+//============================================================================================================
+
+void gdsf_free(gdsf_t cache_) {
+    struct gdsf_s *gdsf = (struct gdsf_s *)cache_;
+
+    assert(gdsf);
+
+    // Pages are not stored in the pools, so they are freed one by one
+    if (gdsf->free_page) {
+        freq_node_t freq = dl_list_get_first(gdsf->base.freq_list);
+        for (; freq; freq = dl_node_get_next(freq)) {
+            local_node_t local = dl_list_get_first(freq_node_get_local(freq));
+            for (; local; local = dl_node_get_next(local)) {
+                gdsf->free_page(local_node_get_data(local).cached);
+            }
+        }
+    }
+
+    base_cache_free(&gdsf->base);
+    rb_tree_free(gdsf->rbtree, NULL);
+
+    free(gdsf);
+}
+
+//============================================================================================================
+
+// Evict the least recently used entry with the lowest key and set age to its key
+
+static void gdsf_evict(struct gdsf_s *gdsf) {
+    base_cache_t *basecache = &gdsf->base;
+
+    freq_node_t first_freq = dl_list_get_first(basecache->freq_list);
+    assert(first_freq);
+
+    local_list_t local_list = freq_node_get_local(first_freq);
+    local_node_t toevict = dl_list_get_last(local_list);
+    local_node_data_t evicted_data = local_node_get_data(toevict);
+
+    gdsf->age = freq_node_get_key(first_freq);
+
+    hashtab_remove_node(basecache->table, base_cache_slot_key(basecache, local_node_get_slot(toevict)));
+    dl_list_remove(local_list, toevict);
+    gdsf_remove_freq_if_empty(gdsf, first_freq);
+
+    gdsf->used -= evicted_data.size;
+    basecache->curr_top -= 1;
+
+    if (gdsf->free_page) {
+        gdsf->free_page(evicted_data.cached);
+    }
+
+    mempool_release(basecache->slot_pool, toevict);
+}
+
+//============================================================================================================
+
+static void *gdsf_get_case_found_impl(struct gdsf_s *gdsf, local_node_t found) {
+    base_cache_t *basecache = &gdsf->base;
+
+    local_node_data_t local_data = local_node_get_data(found);
+    freq_node_t root_node = local_data.root_node;
+
+    basecache->hits += 1;
+    gdsf->byte_hits += local_data.size;
+
+    local_data.frequency += 1;
+
+    // Priority is rounded down, so the next key can be the same as the current one. In this case the entry just moves
+    // to the head of its local list
+    size_t nextkey = gdsf->age + gdsf_priority(local_data.frequency, local_data.cost, local_data.size);
+    freq_node_t next_freq = gdsf_freq_node_find_or_init(gdsf, nextkey);
+
+    dl_list_remove(freq_node_get_local(root_node), found);
+    dl_list_push_front(freq_node_get_local(next_freq), found);
+    gdsf_remove_freq_if_empty(gdsf, root_node);
+
+    local_data.root_node = next_freq;
+    local_node_set_data(found, local_data);
+
+    return local_data.cached;
+}
+
+//============================================================================================================
+
+static void *gdsf_get_case_not_found_impl(struct gdsf_s *gdsf, void *index) {
+    base_cache_t *basecache = &gdsf->base;
+
+    void *page = gdsf->get(index);
+    size_t size = gdsf->size(index, page);
+    assert(size);
+
+    // The page would not fit even into the empty cache
+    if (size > gdsf->capacity) {
+        return page;
+    }
+
+    size_t cost = (gdsf->cost ? gdsf->cost(index, page) : 1);
+
+    // Evict as many entries as needed to fit the page
+    while (gdsf->used + size > gdsf->capacity) {
+        gdsf_evict(gdsf);
+    }
+
+    if (gdsf->age >= BASE_CACHE_RENORMALIZE_DEFAULT) {
+        base_cache_shift_keys(basecache, gdsf->age, 0);
+        gdsf->age = 0;
+    }
+
+    local_node_data_t local_data = {0};
+    local_data.frequency = 1;
+    local_data.cached = page;
+    local_data.index = index;
+    local_data.size = size;
+    local_data.cost = cost;
+    local_data.root_node = gdsf_freq_node_find_or_init(gdsf, gdsf->age + gdsf_priority(1, cost, size));
+
+    local_node_t toinsert = base_cache_node_init(basecache);
+    base_cache_insert(basecache, local_data.root_node, toinsert, local_data);
+
+    gdsf->used += size;
+    basecache->curr_top += 1;
+
+    return page;
+}
+
+//============================================================================================================
+
+void *gdsf_get(gdsf_t cache_, void *index) {
+    struct gdsf_s *gdsf = (struct gdsf_s *)cache_;
+
+    assert(gdsf);
+    assert(index);
+
+    local_node_t found = base_cache_lookup(&gdsf->base, &index);
+
+    if (found) {
+        return gdsf_get_case_found_impl(gdsf, found);
+    }
+
+    return gdsf_get_case_not_found_impl(gdsf, index);
+}
+
+//============================================================================================================
+
+size_t gdsf_get_hits(gdsf_t cache_) {
+    // In this case strict-aliasing does not apply, because base_cache_t is the first member of gdsf_s struct
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->hits;
+}
+
+//============================================================================================================
+
+size_t gdsf_get_byte_hits(gdsf_t cache_) {
+    struct gdsf_s *cache = (struct gdsf_s *)cache_;
+
+    assert(cache);
+
+    return cache->byte_hits;
+}
+
+//============================================================================================================
+
+size_t gdsf_get_used(gdsf_t cache_) {
+    struct gdsf_s *cache = (struct gdsf_s *)cache_;
+
+    assert(cache);
+
+    return cache->used;
+}
+
+//============================================================================================================
+
+size_t gdsf_get_age(gdsf_t cache_) {
+    struct gdsf_s *cache = (struct gdsf_s *)cache_;
+
+    assert(cache);
+
+    return cache->age;
+}
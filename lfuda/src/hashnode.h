@@ -0,0 +1,13 @@
+#ifndef LFUDA_HASHNODE_H
+#define LFUDA_HASHNODE_H
+
+#include "dlnode.h"
+
+// Node of the chaining hash table. It extends list node with the full hash of the entry, so that walking the chains
+// and resizing the table never call the user hash function again. Link must be the first member
+struct hashtab_node_s {
+    struct dl_node_s link;
+    unsigned long hash;
+};
+
+#endif
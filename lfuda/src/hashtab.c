@@ -15,7 +15,10 @@
 #include "memutil.h"
 
 #include "dllist.h"
+#include "hashmix.h"
+#include "hashnode.h"
 #include "hashtab.h"
+#include "hashtab_open.h"
 
 //============================================================================================================
 typedef struct {
@@ -25,17 +28,30 @@ typedef struct {
 #endif
 } buckets_t;
 
-struct hashtab_s {
-    // Single doubly linked list that stores all of the entries
+// Array of buckets that stores the pointers to the first node of the list with the hash corresponding to the index
+// together with the single doubly linked list that stores all of the entries of this array
+typedef struct {
     dl_list_t list;
+    buckets_t *array;
+    size_t size;
+} chain_array_t;
+
+struct hashtab_s {
+    hashtab_backend_t backend;
+
+    // Current bucket array. All of the entries are stored here, unless there is a resize in progress
+    chain_array_t curr;
+    // Bucket array that is being migrated to the current one, its array is NULL if there is no resize in progress.
+    // Buckets with indices lower than migrated are already moved
+    chain_array_t old;
+    size_t migrated;
 
     // Utility functions that have to be provided by the user
     hash_func_t hash;
     entry_cmp_func_t cmp;
     entry_free_func_t free;
 
-    // Hash table stats
-    size_t size;
+    // Hash table stats, these are summed over both of the arrays
     size_t inserts;
     size_t buckets_used;
     size_t collisions;
@@ -44,44 +60,126 @@ struct hashtab_s {
     float load_factor;
 
     int automatic_resize;
-    // Array of buckets that stores the pointers to the first node of the list with the hash corresponding to the index
-    // This array is stored as a flexible array member
-    buckets_t *array;
+    // When disabled, nodes belong to the user and are not freed together with the table
+    int owns_nodes;
 };
 
 //============================================================================================================
 
+// Get full hash of the entry stored in the node
+static inline unsigned long hashtab_node_get_hash(dl_node_t node) {
+    assert(node);
+    return ((struct hashtab_node_s *)node)->hash;
+}
+
+//============================================================================================================
+
+// Select the array in which the entry with full hash is stored. Entries from the buckets that are not migrated yet
+// are still in the old array
+static inline chain_array_t *hashtab_chain_select(struct hashtab_s *table, unsigned long fullhash) {
+    if (table->old.array && hashtab_bucket(fullhash, table->old.size) >= table->migrated) {
+        return &table->old;
+    }
+    return &table->curr;
+}
+
+//============================================================================================================
+
+dl_node_t hashtab_node_init(void *entry) {
+    struct hashtab_node_s *node = calloc_checked(1, sizeof(struct hashtab_node_s));
+    node->link.data = entry;
+    return node;
+}
+
+//============================================================================================================
+
+#ifdef HASHTAB_USE_OPEN_ADDRESSING
+#define HASHTAB_DEFAULT_BACKEND HASHTAB_OPEN_ADDRESSING
+#else
+#define HASHTAB_DEFAULT_BACKEND HASHTAB_CHAINING
+#endif
+
 #define DEFAULT_LOAD_FACTOR 0.7f
-hashtab_t hashtab_init(size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp, entry_free_func_t freefunc) {
+static hashtab_t hashtab_chain_init(size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp,
+                                    entry_free_func_t freefunc) {
     assert(initial_size);
     assert(hash);
     assert(cmp);
 
     struct hashtab_s *table = calloc_checked(1, sizeof(struct hashtab_s));
-    table->list = dl_list_init();
-    table->size = initial_size;
-    table->array = calloc_checked(initial_size, sizeof(buckets_t));
+    table->backend = HASHTAB_CHAINING;
+    table->curr.list = dl_list_init();
+    table->curr.size = hashtab_round_size(initial_size);
+    table->curr.array = calloc_checked(table->curr.size, sizeof(buckets_t));
     table->hash = hash;
     table->cmp = cmp;
     table->free = freefunc;
     table->load_factor = DEFAULT_LOAD_FACTOR;
     table->automatic_resize = 1;
+    table->owns_nodes = 1;
 
     return table;
 }
 
 //============================================================================================================
 
+hashtab_t hashtab_init_backend(hashtab_backend_t backend, size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp,
+                               entry_free_func_t freefunc) {
+    if (backend == HASHTAB_DEFAULT) {
+        backend = HASHTAB_DEFAULT_BACKEND;
+    }
+
+    if (backend == HASHTAB_OPEN_ADDRESSING) {
+        return hashtab_open_init(initial_size, hash, cmp, freefunc);
+    }
+
+    return hashtab_chain_init(initial_size, hash, cmp, freefunc);
+}
+
+//============================================================================================================
+
+hashtab_t hashtab_init(size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp, entry_free_func_t freefunc) {
+    return hashtab_init_backend(HASHTAB_DEFAULT, initial_size, hash, cmp, freefunc);
+}
+
+//============================================================================================================
+
 void hashtab_set_enabled_resize(hashtab_t table_, int enabled) {
     struct hashtab_s *table = (struct hashtab_s *)table_;
     assert(table);
+
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        hashtab_open_set_enabled_resize(table_, enabled);
+        return;
+    }
+
     table->automatic_resize = (enabled ? 1 : 0);
 }
 
 //============================================================================================================
 
+void hashtab_set_owns_nodes(hashtab_t table_, int owns) {
+    struct hashtab_s *table = (struct hashtab_s *)table_;
+    assert(table);
+
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        hashtab_open_set_owns_nodes(table_, owns);
+        return;
+    }
+
+    table->owns_nodes = (owns ? 1 : 0);
+}
+
+//============================================================================================================
+
 void hashtab_set_load_factor(hashtab_t table_, float load_factor) {
     struct hashtab_s *table = table_;
+
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        hashtab_open_set_load_factor(table_, load_factor);
+        return;
+    }
+
     // Assert that the new load factor is in a reasonable range
     assert(load_factor <= 1.0f && load_factor >= 0.0f);
     table->load_factor = load_factor;
@@ -89,10 +187,109 @@ void hashtab_set_load_factor(hashtab_t table_, float load_factor) {
 
 //============================================================================================================
 
+// Link node into the bucket array, the stored hash of the node must already be set
+static void hashtab_insert_impl(struct hashtab_s *table, chain_array_t *arr, dl_node_t node) {
+    assert(table);
+    assert(arr);
+
+    unsigned long hash = hashtab_bucket(hashtab_node_get_hash(node), arr->size);
+    table->inserts++;
+
+    if (arr->array[hash].node == NULL) {    // If there were no nodes in bucket,
+        dl_list_push_back(arr->list, node); // Insert in the end of the list
+        arr->array[hash].node = node;
+        table->buckets_used++;
+    } else {
+        dl_list_insert_after(arr->list, arr->array[hash].node, node); // If there are a number of nodes in bucket
+        table->collisions++;                                          // insert after top of the sublist
+    }
+#ifdef HASHTAB_USE_N_OPTIMIZATION
+    arr->array[hash].n++; // Increment number of nodes in bucket
+#endif
+}
+
+//============================================================================================================
+
+// Move up to nbuckets buckets from the old array to the current one, finishing the resize after the last one
+static void hashtab_migrate(struct hashtab_s *table, size_t nbuckets) {
+    assert(table);
+
+    for (size_t i = 0; i < nbuckets && table->old.array; i++) {
+        chain_array_t *old = &table->old;
+        dl_node_t node = old->array[table->migrated].node;
+
+        // Nodes of the bucket are consecutive in the old list, so they are moved until a node from another bucket
+        size_t moved = 0;
+        while (node && hashtab_bucket(hashtab_node_get_hash(node), old->size) == table->migrated) {
+            dl_node_t next = dl_node_get_next(node);
+            hashtab_insert_impl(table, &table->curr, dl_list_remove(old->list, node));
+            node = next;
+            moved++;
+        }
+
+        // The moved nodes were counted again on insertion, so the old bucket is taken out of the stats
+        if (moved) {
+            table->inserts -= moved;
+            table->collisions -= moved - 1;
+            table->buckets_used--;
+        }
+
+        if (++table->migrated == old->size) {
+            assert(dl_list_is_empty(old->list));
+            dl_list_free(old->list, NULL);
+            free(old->array);
+            *old = (chain_array_t){0};
+            table->migrated = 0;
+        }
+    }
+}
+
+//============================================================================================================
+
+// Move all of the remaining buckets of the old array if there is a resize in progress
+static inline void hashtab_migrate_all(struct hashtab_s *table) {
+    if (table->old.array) {
+        hashtab_migrate(table, table->old.size - table->migrated);
+    }
+}
+
+//============================================================================================================
+
+// Start an incremental resize: current array becomes the old one, and entries are moved by hashtab_migrate
+static void hashtab_migrate_start(struct hashtab_s *table, size_t newsize) {
+    assert(table);
+    assert(!table->old.array);
+
+    table->old = table->curr;
+    table->migrated = 0;
+
+    table->curr.list = dl_list_init();
+    table->curr.size = hashtab_round_size(newsize);
+    table->curr.array = calloc_checked(table->curr.size, sizeof(buckets_t));
+}
+
+//============================================================================================================
+
 void hashtab_free(hashtab_t table_) {
     struct hashtab_s *table = (struct hashtab_s *)table_;
-    dl_list_free(table->list, table->free);
-    free(table->array);
+
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        hashtab_open_free(table_);
+        return;
+    }
+
+    hashtab_migrate_all(table);
+
+    // Unlink user-owned nodes, so that dl_list_free does not free them
+    while (!table->owns_nodes && !dl_list_is_empty(table->curr.list)) {
+        dl_node_t node = dl_list_pop_front(table->curr.list);
+        if (table->free) {
+            table->free(dl_node_get_data(node));
+        }
+    }
+
+    dl_list_free(table->curr.list, table->free);
+    free(table->curr.array);
     free(table);
 }
 
@@ -102,84 +299,90 @@ hashtab_stat_t hashtab_get_stat(hashtab_t table_) {
     struct hashtab_s *table = (struct hashtab_s *)table_;
     hashtab_stat_t stat;
 
-    stat.size = table->size;
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        return hashtab_open_get_stat(table_);
+    }
+
+    stat.size = table->curr.size;
     stat.inserts = table->inserts;
     stat.used = table->buckets_used;
     stat.collisions = table->collisions;
+    stat.migrated = table->migrated;
+    stat.migrating = table->old.size;
 
     return stat;
 }
 
 //============================================================================================================
 
-static void hashtab_insert_impl(hashtab_t *table_, dl_node_t node) {
+#define ENCR_MULTIPLIER 2
+void hashtab_insert_node(hashtab_t *table_, dl_node_t node) {
     struct hashtab_s *table = *(struct hashtab_s **)table_;
 
     assert(table);
+    assert(node);
 
-    unsigned long hash = table->hash(dl_node_get_data(node)) % table->size;
-    table->inserts++;
-
-    if (table->array[hash].node == NULL) {    // If there were no nodes in bucket,
-        dl_list_push_back(table->list, node); // Insert in the end of the list
-        table->array[hash].node = node;
-        table->buckets_used++;
-    } else {
-        dl_list_insert_after(table->list, table->array[hash].node, node); // If there are a number of nodes in bucket
-        table->collisions++;                                              // insert after top of the sublist
+    if (hashtab_get_backend(table) == HASHTAB_OPEN_ADDRESSING) {
+        hashtab_open_insert(table, dl_node_get_data(node), node);
+        return;
     }
-#ifdef HASHTAB_USE_N_OPTIMIZATION
-    table->array[hash].n++; // Increment number of nodes in bucket
-#endif
-}
-
-//============================================================================================================
-
-#define ENCR_MULTIPLIER 2
-void hashtab_insert(hashtab_t *table_, void *entry) {
-    struct hashtab_s *table = *(struct hashtab_s **)table_;
 
-    assert(table);
-    assert(entry);
+    // The hash is computed only once here, after that only the stored one is used
+    unsigned long fullhash = hashtab_mix(table->hash(dl_node_get_data(node)));
+    ((struct hashtab_node_s *)node)->hash = fullhash;
 
     if (table->automatic_resize) {
-        if ((float)table->inserts > table->load_factor * (float)table->size) { // Resize if many insertions done
+        if ((float)table->inserts > table->load_factor * (float)table->curr.size) { // Resize if many insertions done
             // This is a funny bug actually, because if initial size is one, then 2 * 1 - 1 is also 1 ;)
-            // So this is necessary to handle this edge case
-            size_t new_size = ENCR_MULTIPLIER * table->size - 1;
-            if (table->size == 1) {
-                new_size = ENCR_MULTIPLIER * table->size;
+            // So this is necessary to handle this edge case. Power of two sizes are mixed and need no adjustment
+            size_t new_size = ENCR_MULTIPLIER * table->curr.size - 1;
+            if (table->curr.size == 1 || HASHTAB_POW2_SIZES) {
+                new_size = ENCR_MULTIPLIER * table->curr.size;
             }
 
-            table = hashtab_resize(table, new_size);
             // Note that new size is (old_size * MULT - 1) to avoid sizes that are powers of MULT
-            *table_ = table;
+            // The previous resize can only be in progress here with a custom load factor close to zero
+            hashtab_migrate_all(table);
+            hashtab_migrate_start(table, new_size);
         }
     }
 
-    dl_node_t node = dl_node_init(entry); // Create new node
-    hashtab_insert_impl(table_, node);
+    hashtab_migrate(table, HASHTAB_MIGRATE_STEP);
+    hashtab_insert_impl(table, hashtab_chain_select(table, fullhash), node);
 }
 
 //============================================================================================================
 
-void *hashtab_lookup(hashtab_t table_, const void *key) {
-    struct hashtab_s *table = (struct hashtab_s *)table_;
+void hashtab_insert(hashtab_t *table_, void *entry) {
+    assert(table_);
+    assert(entry);
 
-    assert(table);
-    assert(key);
+    // Open addressing stores entries inline and does not need a node
+    if (hashtab_get_backend(*table_) == HASHTAB_OPEN_ADDRESSING) {
+        hashtab_open_insert(*table_, entry, NULL);
+        return;
+    }
+
+    dl_node_t node = hashtab_node_init(entry); // Create new node
+    hashtab_insert_node(table_, node);
+}
+
+//============================================================================================================
 
-    unsigned long hash = table->hash(key) % table->size;
-    dl_node_t find = table->array[hash].node;
+// Find the entry with key and full hash in the bucket array, NULL if it is absent
+static inline void *hashtab_chain_find(struct hashtab_s *table, chain_array_t *arr, unsigned long fullhash,
+                                       const void *key) {
+    unsigned long hash = hashtab_bucket(fullhash, arr->size);
+    dl_node_t find = arr->array[hash].node;
 
     if (!find) {
         return NULL;
     }
 
 #ifdef HASHTAB_USE_N_OPTIMIZATION // Using number of nodes in bucket
-    size_t capacity = table->array[hash].n;
+    size_t capacity = arr->array[hash].n;
     for (size_t i = 0; i < capacity; i++) {
-        if (table->cmp(dl_node_get_data(find), key) == 0) {
+        if (hashtab_node_get_hash(find) == fullhash && table->cmp(dl_node_get_data(find), key) == 0) {
             return dl_node_get_data(find);
         }
         find = dl_node_get_next(find);
@@ -188,13 +391,13 @@ void *hashtab_lookup(hashtab_t table_, const void *key) {
 #else // Using hash
     unsigned long temphash = hash;
     while (temphash == hash) {
-        if (table->cmp(dl_node_get_data(find), key) == 0) {
+        if (hashtab_node_get_hash(find) == fullhash && table->cmp(dl_node_get_data(find), key) == 0) {
             return dl_node_get_data(find);
         }
         if (!(find = dl_node_get_next(find))) {
             break;
         }
-        temphash = table->hash(dl_node_get_data(find)) % table->size; // Update hash
+        temphash = hashtab_bucket(hashtab_node_get_hash(find), arr->size); // Update hash
     }
 #endif
 
@@ -203,34 +406,98 @@ void *hashtab_lookup(hashtab_t table_, const void *key) {
 
 //============================================================================================================
 
-#ifdef HASHTAB_USE_N_OPTIMIZATION
-static inline void *hashtab_remove_use_n_impl(hashtab_t table_, void *key) {
+void *hashtab_lookup(hashtab_t table_, const void *key) {
     struct hashtab_s *table = (struct hashtab_s *)table_;
 
-    assert(table_);
+    assert(table);
+    assert(key);
+
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        return hashtab_open_lookup(table_, key);
+    }
+
+    hashtab_migrate(table, HASHTAB_MIGRATE_STEP);
+
+    // Full hash is compared before calling cmp, so that cmp is called only for real matches most of the time
+    unsigned long fullhash = hashtab_mix(table->hash(key));
+    return hashtab_chain_find(table, hashtab_chain_select(table, fullhash), fullhash, key);
+}
+
+//============================================================================================================
+
+void hashtab_lookup_many(hashtab_t table_, const void **keys, void **results, size_t count) {
+    struct hashtab_s *table = (struct hashtab_s *)table_;
+
+    assert(table);
+    assert(keys);
+    assert(results);
+
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        hashtab_open_lookup_many(table_, keys, results, count);
+        return;
+    }
+
+    hashtab_migrate(table, HASHTAB_MIGRATE_STEP * count);
+
+    unsigned long fullhashes[HASHTAB_BATCH];
+    chain_array_t *arrs[HASHTAB_BATCH];
+    buckets_t *buckets[HASHTAB_BATCH];
+
+    for (size_t start = 0; start < count; start += HASHTAB_BATCH) {
+        size_t batch = (count - start < HASHTAB_BATCH ? count - start : HASHTAB_BATCH);
+
+        // 1. Hash all of the keys and prefetch their buckets
+        for (size_t i = 0; i < batch; i++) {
+            fullhashes[i] = hashtab_mix(table->hash(keys[start + i]));
+            arrs[i] = hashtab_chain_select(table, fullhashes[i]);
+            buckets[i] = &arrs[i]->array[hashtab_bucket(fullhashes[i], arrs[i]->size)];
+            hashtab_prefetch(buckets[i]);
+        }
+
+        // 2. Prefetch the first nodes of the chains, by now the buckets should be in the cache
+        for (size_t i = 0; i < batch; i++) {
+            hashtab_prefetch(buckets[i]->node);
+        }
+
+        // 3. Resolve the keys in the same way as hashtab_lookup does
+        for (size_t i = 0; i < batch; i++) {
+            results[start + i] = hashtab_chain_find(table, arrs[i], fullhashes[i], keys[start + i]);
+        }
+    }
+}
+
+//============================================================================================================
+
+#ifdef HASHTAB_USE_N_OPTIMIZATION
+static inline dl_node_t hashtab_remove_use_n_impl(struct hashtab_s *table, const void *key) {
+    assert(table);
     assert(key);
 
-    unsigned long hash = table->hash(key) % table->size;
-    dl_list_t find = table->array[hash].node;
+    unsigned long fullhash = hashtab_mix(table->hash(key));
+    chain_array_t *arr = hashtab_chain_select(table, fullhash);
+    unsigned long hash = hashtab_bucket(fullhash, arr->size);
+    dl_node_t find = arr->array[hash].node;
 
     if (!find) {
         return NULL;
     }
 
-    size_t capacity = table->array[hash].n;
+    size_t capacity = arr->array[hash].n;
     for (size_t i = 0; i < capacity; i++) {
-        if (table->cmp(dl_node_get_data(find), key) == 0) {
+        if (hashtab_node_get_hash(find) == fullhash && table->cmp(dl_node_get_data(find), key) == 0) {
             if (capacity > 1) {
                 table->collisions--; // Decrement number of collisions if there were many nodes in bucket
+                if (find == arr->array[hash].node) {
+                    arr->array[hash].node = dl_node_get_next(find); // Move the bucket pointer off the removed node
+                }
             } else {
-                table->array[hash].node = NULL; // If only one - clear the bucket
+                arr->array[hash].node = NULL; // If only one - clear the bucket
+                table->buckets_used--;
             }
             table->inserts--;
-            table->array[hash].n--;
+            arr->array[hash].n--;
 
-            void *result = dl_node_get_data(dl_list_remove(table->list, find));
-            dl_node_free(find, NULL);
-            return result;
+            return dl_list_remove(arr->list, find);
         }
         find = dl_node_get_next(find);
     }
@@ -241,17 +508,14 @@ static inline void *hashtab_remove_use_n_impl(hashtab_t table_, void *key) {
 
 //============================================================================================================
 
-static inline void *hashtab_remove_impl_no_n_impl(hashtab_t table_, void *key) {
-    struct hashtab_s *table = (struct hashtab_s *)table_;
-
-    assert(table_);
+static inline dl_node_t hashtab_remove_impl_no_n_impl(struct hashtab_s *table, const void *key) {
+    assert(table);
     assert(key);
 
-    unsigned long hash = table->hash(key) % table->size;
-    dl_list_t find = table->array[hash].node;
-
-    // Return value (pointer to the data)
-    void *result = NULL;
+    unsigned long fullhash = hashtab_mix(table->hash(key));
+    chain_array_t *arr = hashtab_chain_select(table, fullhash);
+    unsigned long hash = hashtab_bucket(fullhash, arr->size);
+    dl_node_t find = arr->array[hash].node;
 
     if (!find) {
         return NULL;
@@ -262,22 +526,20 @@ static inline void *hashtab_remove_impl_no_n_impl(hashtab_t table_, void *key) {
 
     // If next is NULL, then we remove the entry from the bucket. The same applies if the next bucket has a different
     // hash
-    if ((table->cmp(dl_node_get_data(find), key) == 0)) {
-        if (!next || (next && (table->hash(dl_node_get_data(next)) % table->size != hash))) {
-            table->array[hash].node = NULL;
+    if (hashtab_node_get_hash(find) == fullhash && table->cmp(dl_node_get_data(find), key) == 0) {
+        if (!next || (next && (hashtab_bucket(hashtab_node_get_hash(next), arr->size) != hash))) {
+            arr->array[hash].node = NULL;
             table->buckets_used--;
         } else {
             // In this case there are more nodes after the first and we happily move the bucket pointer futher along
-            table->array[hash].node = next;
+            arr->array[hash].node = next;
             table->collisions--;
         }
 
         // In any case the counter gets decremented
         table->inserts--;
 
-        result = dl_node_get_data(dl_list_remove(table->list, find));
-        dl_node_free(find, NULL);
-        return result;
+        return dl_list_remove(arr->list, find);
     }
 
     find = next;
@@ -286,21 +548,20 @@ static inline void *hashtab_remove_impl_no_n_impl(hashtab_t table_, void *key) {
     }
 
     // From now on we can assume that there are some previous nodes with the same hash
+    temphash = hashtab_bucket(hashtab_node_get_hash(find), arr->size);
     while (temphash == hash) {
-        if (table->cmp(dl_node_get_data(find), key) == 0) {
+        if (hashtab_node_get_hash(find) == fullhash && table->cmp(dl_node_get_data(find), key) == 0) {
             table->collisions--;
             table->inserts--;
 
-            result = dl_node_get_data(dl_list_remove(table->list, find));
-            dl_node_free(find, NULL);
-            return result;
+            return dl_list_remove(arr->list, find);
         }
 
         if (!(find = dl_node_get_next(find))) {
             break;
         }
 
-        temphash = table->hash(dl_node_get_data(find)) % table->size; // update hash
+        temphash = hashtab_bucket(hashtab_node_get_hash(find), arr->size); // update hash
     }
 
     return NULL;
@@ -309,32 +570,63 @@ static inline void *hashtab_remove_impl_no_n_impl(hashtab_t table_, void *key) {
 
 //============================================================================================================
 
-void *hashtab_remove(hashtab_t table_, void *key) {
+dl_node_t hashtab_remove_node(hashtab_t table_, const void *key) {
+    struct hashtab_s *table = (struct hashtab_s *)table_;
+
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        dl_node_t node = NULL;
+        hashtab_open_remove(table_, key, &node);
+        return node;
+    }
+
+    hashtab_migrate(table, HASHTAB_MIGRATE_STEP);
+
 #ifdef HASHTAB_USE_N_OPTIMIZATION // Using number of nodes in bucket
-    return hashtab_remove_use_n_impl(table_, key);
+    return hashtab_remove_use_n_impl(table, key);
 #else // Using hash
-    return hashtab_remove_impl_no_n_impl(table_, key);
+    return hashtab_remove_impl_no_n_impl(table, key);
 #endif
 }
 
 //============================================================================================================
 
-// Resize the table by moving nodes from the old table's list to a newly allocated one and return the handle.
+void *hashtab_remove(hashtab_t table_, void *key) {
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        dl_node_t node = NULL;
+        void *result = hashtab_open_remove(table_, key, &node);
+        if (node) {
+            dl_node_free(node, NULL);
+        }
+        return result;
+    }
+
+    dl_node_t node = hashtab_remove_node(table_, key);
+
+    if (!node) {
+        return NULL;
+    }
+
+    void *result = dl_node_get_data(node);
+    dl_node_free(node, NULL);
+    return result;
+}
+
+//============================================================================================================
+
+// Resize the table at once. Automatic resizes are incremental and do not go through this function
 hashtab_t hashtab_resize(hashtab_t table_, size_t newsize) {
     struct hashtab_s *table = (struct hashtab_s *)table_;
 
     assert(table);
     assert(newsize);
 
-    // Creating a new hash table
-    struct hashtab_s *new_table = hashtab_init(newsize, table->hash, table->cmp, table->free);
-
-    // Creating node for passing through the old list
-    while (!dl_list_is_empty(table->list)) {
-        dl_node_t node = dl_list_pop_front(table->list);
-        hashtab_insert_impl((hashtab_t *)&new_table, node); // Move the node to the new table
+    if (hashtab_get_backend(table_) == HASHTAB_OPEN_ADDRESSING) {
+        return hashtab_open_resize(table_, newsize);
     }
-    // Free old hash table
-    hashtab_free(table);
-    return new_table;
+
+    hashtab_migrate_all(table);
+    hashtab_migrate_start(table, newsize);
+    hashtab_migrate_all(table);
+
+    return table;
 }
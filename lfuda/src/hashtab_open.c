@@ -0,0 +1,446 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+#include "memutil.h"
+
+#include "dllist.h"
+#include "hashtab.h"
+#include "hashmix.h"
+#include "hashtab_open.h"
+
+//============================================================================================================
+
+// Refer to https://programming.guide/robin-hood-hashing.html for more information
+
+// Entries are stored inline together with their full hash, so that probing compares hashes without calling the user
+// hash function or dereferencing the entry. Node is only set for entries inserted with hashtab_insert_node
+typedef struct {
+    unsigned long hash;
+    void *entry;
+    dl_node_t node;
+} open_bucket_t;
+
+// Bucket array together with the number of entries stored in it
+typedef struct {
+    open_bucket_t *array;
+    size_t size;
+    size_t inserts;
+} open_array_t;
+
+struct hashtab_open_s {
+    hashtab_backend_t backend;
+
+    // Utility functions that have to be provided by the user
+    hash_func_t hash;
+    entry_cmp_func_t cmp;
+    entry_free_func_t free;
+
+    // Current bucket array. All of the entries are stored here, unless there is a resize in progress
+    open_array_t curr;
+    // Bucket array that is being migrated to the current one, its array is NULL if there is no resize in progress.
+    // Buckets with indices lower than migrated are already empty
+    open_array_t old;
+    size_t migrated;
+
+    // Critical load factor
+    float load_factor;
+
+    int automatic_resize;
+    int owns_nodes;
+};
+
+//============================================================================================================
+
+#define DEFAULT_LOAD_FACTOR 0.7f
+hashtab_t hashtab_open_init(size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp, entry_free_func_t freefunc) {
+    assert(initial_size);
+    assert(hash);
+    assert(cmp);
+
+    struct hashtab_open_s *table = calloc_checked(1, sizeof(struct hashtab_open_s));
+    table->backend = HASHTAB_OPEN_ADDRESSING;
+    table->curr.size = hashtab_round_size(initial_size);
+    table->curr.array = calloc_checked(table->curr.size, sizeof(open_bucket_t));
+    table->hash = hash;
+    table->cmp = cmp;
+    table->free = freefunc;
+    table->load_factor = DEFAULT_LOAD_FACTOR;
+    table->automatic_resize = 1;
+    table->owns_nodes = 1;
+
+    return table;
+}
+
+//============================================================================================================
+
+void hashtab_open_set_enabled_resize(hashtab_t table_, int enabled) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+    assert(table);
+    table->automatic_resize = (enabled ? 1 : 0);
+}
+
+//============================================================================================================
+
+void hashtab_open_set_owns_nodes(hashtab_t table_, int owns) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+    assert(table);
+    table->owns_nodes = (owns ? 1 : 0);
+}
+
+//============================================================================================================
+
+void hashtab_open_set_load_factor(hashtab_t table_, float load_factor) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+    // Assert that the new load factor is in a reasonable range
+    assert(load_factor <= 1.0f && load_factor >= 0.0f);
+    table->load_factor = load_factor;
+}
+
+//============================================================================================================
+
+static void hashtab_open_free_array(struct hashtab_open_s *table, open_array_t *arr) {
+    for (size_t i = 0; i < arr->size; ++i) {
+        open_bucket_t *bucket = &arr->array[i];
+        if (!bucket->entry) {
+            continue;
+        }
+
+        if (table->free) {
+            table->free(bucket->entry);
+        }
+
+        if (table->owns_nodes && bucket->node) {
+            dl_node_free(bucket->node, NULL);
+        }
+    }
+
+    free(arr->array);
+}
+
+//============================================================================================================
+
+void hashtab_open_free(hashtab_t table_) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+
+    hashtab_open_free_array(table, &table->curr);
+    hashtab_open_free_array(table, &table->old);
+    free(table);
+}
+
+//============================================================================================================
+
+// Distance of the bucket at index from the home bucket of the entry stored in it
+static inline size_t hashtab_open_probe_distance(open_array_t *arr, size_t index, unsigned long hash) {
+    size_t home = hashtab_bucket(hash, arr->size);
+    return (index >= home ? index - home : index + arr->size - home);
+}
+
+//============================================================================================================
+
+static size_t hashtab_open_count_collisions(open_array_t *arr) {
+    // Every entry occupies its own bucket, so an entry that is not in its home bucket is counted as a collision
+    size_t collisions = 0;
+    for (size_t i = 0; i < arr->size; ++i) {
+        if (arr->array[i].entry && hashtab_open_probe_distance(arr, i, arr->array[i].hash)) {
+            collisions++;
+        }
+    }
+    return collisions;
+}
+
+//============================================================================================================
+
+hashtab_stat_t hashtab_open_get_stat(hashtab_t table_) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+    hashtab_stat_t stat;
+
+    stat.size = table->curr.size;
+    stat.inserts = table->curr.inserts + table->old.inserts;
+    stat.used = stat.inserts;
+    stat.collisions = hashtab_open_count_collisions(&table->curr) + hashtab_open_count_collisions(&table->old);
+    stat.migrated = table->migrated;
+    stat.migrating = table->old.size;
+
+    return stat;
+}
+
+//============================================================================================================
+
+// Insert bucket into the array with Robin Hood strategy: an entry that is further away from its home bucket takes the
+// place of the one that is closer to its own
+static void hashtab_open_insert_impl(open_array_t *arr, open_bucket_t toinsert) {
+    assert(arr);
+    assert(arr->inserts < arr->size);
+
+    size_t index = hashtab_bucket(toinsert.hash, arr->size);
+    size_t distance = 0;
+
+    while (arr->array[index].entry) {
+        size_t current_distance = hashtab_open_probe_distance(arr, index, arr->array[index].hash);
+
+        if (current_distance < distance) {
+            open_bucket_t temp = arr->array[index];
+            arr->array[index] = toinsert;
+            toinsert = temp;
+            distance = current_distance;
+        }
+
+        index = (index + 1 == arr->size ? 0 : index + 1);
+        distance++;
+    }
+
+    arr->array[index] = toinsert;
+    arr->inserts++;
+}
+
+//============================================================================================================
+
+// Empty the bucket at index with backward shift deletion: move the following entries one bucket closer to home until
+// an empty bucket or an entry that is already in its home bucket is found. This keeps probe sequences short without
+// tombstones
+static void hashtab_open_remove_at(open_array_t *arr, size_t index) {
+    size_t next = (index + 1 == arr->size ? 0 : index + 1);
+    while (arr->array[next].entry && hashtab_open_probe_distance(arr, next, arr->array[next].hash)) {
+        arr->array[index] = arr->array[next];
+        index = next;
+        next = (next + 1 == arr->size ? 0 : next + 1);
+    }
+
+    arr->array[index].entry = NULL;
+    arr->array[index].node = NULL;
+    arr->inserts--;
+}
+
+//============================================================================================================
+
+// Look at up to nbuckets buckets of the old array and move their entries to the current one, finishing the resize
+// after the last entry. Removal shifts the following entries back, so a bucket is looked at again until it is empty.
+// Backward shift never crosses an empty bucket, so the buckets before migrated stay empty until the end of the resize
+static void hashtab_open_migrate(struct hashtab_open_s *table, size_t nbuckets) {
+    assert(table);
+
+    for (size_t i = 0; i < nbuckets && table->old.array; i++) {
+        open_array_t *old = &table->old;
+        open_bucket_t *bucket = &old->array[table->migrated];
+
+        if (bucket->entry) {
+            // Stored hashes are reused, so the user hash function is not called again
+            open_bucket_t moved = *bucket;
+            hashtab_open_remove_at(old, table->migrated);
+            hashtab_open_insert_impl(&table->curr, moved);
+        } else {
+            table->migrated++;
+        }
+
+        if (!old->inserts) {
+            free(old->array);
+            *old = (open_array_t){0};
+            table->migrated = 0;
+        }
+    }
+}
+
+//============================================================================================================
+
+// Move all of the remaining entries of the old array if there is a resize in progress
+static inline void hashtab_open_migrate_all(struct hashtab_open_s *table) {
+    if (table->old.array) {
+        hashtab_open_migrate(table, SIZE_MAX);
+    }
+}
+
+//============================================================================================================
+
+// Start an incremental resize: current array becomes the old one, and entries are moved by hashtab_open_migrate
+static void hashtab_open_migrate_start(struct hashtab_open_s *table, size_t newsize) {
+    assert(table);
+    assert(!table->old.array);
+
+    table->old = table->curr;
+    table->migrated = 0;
+
+    table->curr.size = hashtab_round_size(newsize);
+    table->curr.array = calloc_checked(table->curr.size, sizeof(open_bucket_t));
+    table->curr.inserts = 0;
+
+    // An empty array needs no migration
+    if (!table->old.inserts) {
+        free(table->old.array);
+        table->old = (open_array_t){0};
+    }
+}
+
+//============================================================================================================
+
+hashtab_t hashtab_open_resize(hashtab_t table_, size_t newsize) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+
+    assert(table);
+    assert(newsize >= table->curr.inserts + table->old.inserts);
+
+    // Explicit resizes are done at once
+    hashtab_open_migrate_all(table);
+    hashtab_open_migrate_start(table, newsize);
+    hashtab_open_migrate_all(table);
+
+    return table;
+}
+
+//============================================================================================================
+
+#define ENCR_MULTIPLIER 2
+void hashtab_open_insert(hashtab_t table_, void *entry, dl_node_t node) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+
+    assert(table);
+    assert(entry);
+
+    // Unlike chaining, open addressing can not store more entries than there are buckets. Entries of the old array
+    // are counted as well, because all of them end up in the current one
+    size_t inserts = table->curr.inserts + table->old.inserts;
+    if (table->automatic_resize &&
+        ((float)inserts > table->load_factor * (float)table->curr.size || inserts + 1 > table->curr.size)) {
+        // The previous resize can only be in progress here with a custom load factor close to zero
+        hashtab_open_migrate_all(table);
+        hashtab_open_migrate_start(table, ENCR_MULTIPLIER * table->curr.size);
+    } else if (inserts == table->curr.size) {
+        ERROR("Trying to insert into a full hash table with resizing disabled\n");
+    }
+
+    hashtab_open_migrate(table, HASHTAB_MIGRATE_STEP);
+
+    open_bucket_t toinsert = {0};
+    toinsert.hash = hashtab_mix(table->hash(entry));
+    toinsert.entry = entry;
+    toinsert.node = node;
+
+    hashtab_open_insert_impl(&table->curr, toinsert);
+}
+
+//============================================================================================================
+
+// Returns index of the bucket of arr with key, or arr->size if it is absent
+static size_t hashtab_open_find_hash(struct hashtab_open_s *table, open_array_t *arr, unsigned long hash,
+                                     const void *key) {
+    assert(table);
+    assert(key);
+
+    size_t index = hashtab_bucket(hash, arr->size);
+
+    for (size_t distance = 0; arr->array[index].entry; ++distance) {
+        open_bucket_t *bucket = &arr->array[index];
+
+        // Robin Hood invariant: the key would have been placed before any entry closer to its home bucket
+        if (hashtab_open_probe_distance(arr, index, bucket->hash) < distance) {
+            break;
+        }
+
+        if (bucket->hash == hash && table->cmp(bucket->entry, key) == 0) {
+            return index;
+        }
+
+        index = (index + 1 == arr->size ? 0 : index + 1);
+    }
+
+    return arr->size;
+}
+
+//============================================================================================================
+
+// Find the key in the current array and then in the old one. Returns the array it is stored in, NULL if it is absent
+static open_array_t *hashtab_open_find(struct hashtab_open_s *table, unsigned long hash, const void *key,
+                                       size_t *index) {
+    *index = hashtab_open_find_hash(table, &table->curr, hash, key);
+    if (*index != table->curr.size) {
+        return &table->curr;
+    }
+
+    if (table->old.array) {
+        *index = hashtab_open_find_hash(table, &table->old, hash, key);
+        if (*index != table->old.size) {
+            return &table->old;
+        }
+    }
+
+    return NULL;
+}
+
+//============================================================================================================
+
+void *hashtab_open_lookup(hashtab_t table_, const void *key) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+
+    hashtab_open_migrate(table, HASHTAB_MIGRATE_STEP);
+
+    size_t index = 0;
+    open_array_t *arr = hashtab_open_find(table, hashtab_mix(table->hash(key)), key, &index);
+    return (arr ? arr->array[index].entry : NULL);
+}
+
+//============================================================================================================
+
+void hashtab_open_lookup_many(hashtab_t table_, const void **keys, void **results, size_t count) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+    unsigned long hashes[HASHTAB_BATCH];
+
+    hashtab_open_migrate(table, HASHTAB_MIGRATE_STEP * count);
+
+    open_array_t *arr = &table->curr;
+
+    for (size_t start = 0; start < count; start += HASHTAB_BATCH) {
+        size_t batch = (count - start < HASHTAB_BATCH ? count - start : HASHTAB_BATCH);
+
+        // 1. Hash all of the keys and prefetch their home buckets
+        for (size_t i = 0; i < batch; i++) {
+            hashes[i] = hashtab_mix(table->hash(keys[start + i]));
+            hashtab_prefetch(&arr->array[hashtab_bucket(hashes[i], arr->size)]);
+        }
+
+        // 2. Prefetch the entries in the home buckets, which are the first ones to be compared
+        for (size_t i = 0; i < batch; i++) {
+            hashtab_prefetch(arr->array[hashtab_bucket(hashes[i], arr->size)].entry);
+        }
+
+        // 3. Probe for the keys in the same way as hashtab_open_lookup does. Keys that are still in the old array
+        // during a resize are not prefetched
+        for (size_t i = 0; i < batch; i++) {
+            size_t index = 0;
+            open_array_t *found = hashtab_open_find(table, hashes[i], keys[start + i], &index);
+            results[start + i] = (found ? found->array[index].entry : NULL);
+        }
+    }
+}
+
+//============================================================================================================
+
+void *hashtab_open_remove(hashtab_t table_, const void *key, dl_node_t *node) {
+    struct hashtab_open_s *table = (struct hashtab_open_s *)table_;
+
+    hashtab_open_migrate(table, HASHTAB_MIGRATE_STEP);
+
+    size_t index = 0;
+    open_array_t *arr = hashtab_open_find(table, hashtab_mix(table->hash(key)), key, &index);
+    if (!arr) {
+        *node = NULL;
+        return NULL;
+    }
+
+    void *result = arr->array[index].entry;
+    *node = arr->array[index].node;
+
+    hashtab_open_remove_at(arr, index);
+
+    return result;
+}
@@ -0,0 +1,33 @@
+#ifndef LFUDA_HASHTAB_OPEN_H
+#define LFUDA_HASHTAB_OPEN_H
+
+#include "dllist.h"
+#include "hashtab.h"
+
+#include <stddef.h>
+
+// Open addressing backend of the hash table. Public functions in hashtab.c dispatch to these, when the table has been
+// initialized with HASHTAB_OPEN_ADDRESSING. Every backend struct starts with the backend tag
+
+static inline hashtab_backend_t hashtab_get_backend(hashtab_t table_) {
+    return *(hashtab_backend_t *)table_;
+}
+
+hashtab_t hashtab_open_init(size_t initial_size, hash_func_t hash, entry_cmp_func_t cmp, entry_free_func_t freefunc);
+void hashtab_open_free(hashtab_t table_);
+
+void hashtab_open_set_load_factor(hashtab_t table_, float load_factor);
+void hashtab_open_set_enabled_resize(hashtab_t table_, int enabled);
+void hashtab_open_set_owns_nodes(hashtab_t table_, int owns);
+
+hashtab_stat_t hashtab_open_get_stat(hashtab_t table_);
+
+void hashtab_open_insert(hashtab_t table_, void *entry, dl_node_t node);
+void *hashtab_open_lookup(hashtab_t table_, const void *key);
+void hashtab_open_lookup_many(hashtab_t table_, const void **keys, void **results, size_t count);
+hashtab_t hashtab_open_resize(hashtab_t table_, size_t newsize);
+
+// Remove key from the table. Returns entry and stores the node it was inserted with in *node
+void *hashtab_open_remove(hashtab_t table_, const void *key, dl_node_t *node);
+
+#endif
@@ -13,6 +13,7 @@
 #include "hashtab.h"
 
 #include "clist.h"
+#include "policies.h"
 #include <assert.h>
 #include <string.h>
 
@@ -37,13 +38,15 @@ lfu_t lfu_init(cache_init_t init) {
 
 // Get next freq node and create one if there is no immediate successor. If freqnode is NULL, then return frequency node
 // with key 1, or create one if there are none
-static freq_node_t next_freq_node_init(freq_list_t list, freq_node_t freqnode) {
-    assert(list);
+static freq_node_t next_freq_node_init(base_cache_t *cache, freq_node_t freqnode) {
+    assert(cache);
+
+    freq_list_t list = cache->freq_list;
 
     if (!freqnode) {
         freq_node_t first_freq = dl_list_get_first(list);
         if (!first_freq || freq_node_get_key(first_freq) != 1) {
-            freq_node_t new_freq = freq_node_init(1);
+            freq_node_t new_freq = freq_node_init(cache->freq_pool, 1);
             dl_list_push_front(list, new_freq);
             return new_freq;
         }
@@ -57,7 +60,7 @@ static freq_node_t next_freq_node_init(freq_list_t list, freq_node_t freqnode) {
         return next_freq;
     }
 
-    next_freq = freq_node_init(nextkey);
+    next_freq = freq_node_init(cache->freq_pool, nextkey);
     dl_list_insert_after(list, freqnode, next_freq);
 
     return next_freq;
@@ -65,11 +68,62 @@ static freq_node_t next_freq_node_init(freq_list_t list, freq_node_t freqnode) {
 
 //============================================================================================================
 
+// Entries that pass admission start with frequency 1 as well
+static freq_node_t lfu_first_freq_node_init(base_cache_t *cache) {
+    return next_freq_node_init(cache, NULL);
+}
+
+// Entries that are unpinned keep their frequency, so the node is found by walking the list from the node they were
+// pinned from, which has a smaller key unless it has been reused for another one
+static freq_node_t lfu_find_freq(base_cache_t *cache, freq_node_t from, size_t frequency) {
+    assert(cache);
+
+    if (from && freq_node_get_key(from) == frequency) {
+        return from;
+    }
+    from = (from && freq_node_get_key(from) < frequency ? from : NULL);
+
+    freq_node_t prev = from;
+    freq_node_t next = (from ? dl_node_get_next(from) : dl_list_get_first(cache->freq_list));
+
+    while (next && freq_node_get_key(next) < frequency) {
+        prev = next;
+        next = dl_node_get_next(next);
+    }
+
+    if (next && freq_node_get_key(next) == frequency) {
+        return next;
+    }
+
+    freq_node_t new_freq = freq_node_init(cache->freq_pool, frequency);
+    if (!prev) {
+        dl_list_push_front(cache->freq_list, new_freq);
+    } else {
+        dl_list_insert_after(cache->freq_list, prev, new_freq);
+    }
+
+    return new_freq;
+}
+
+static const base_cache_policy_t lfu_policy = {lfu_first_freq_node_init, NULL, lfu_find_freq};
+
+//============================================================================================================
+
 // Case 1. When there is already a node present
 static void *lfu_promote(base_cache_t *cache, local_node_t found) {
     assert(cache);
     assert(found);
 
+    // Pinned entries are off the frequency list until they are unpinned
+    if (base_cache_is_pinned(cache, found)) {
+        return base_cache_pinned_hit(cache, found);
+    }
+
+    // Entries in the admission window are only reordered
+    if (base_cache_in_window(cache, found)) {
+        return base_cache_window_hit(cache, found);
+    }
+
     // Increment hits counter
     cache->hits++;
 
@@ -82,7 +136,7 @@ static void *lfu_promote(base_cache_t *cache, local_node_t found) {
     // Remove node from this list and move to the freq node with incremented key
     local_list_t local_list = freq_data.local_list;
     dl_list_remove(local_list, found);
-    freq_node_t next_freq = next_freq_node_init(cache->freq_list, root_node);
+    freq_node_t next_freq = next_freq_node_init(cache, root_node);
     local_data.root_node = next_freq;
 
     // If frequency node is empty, then remove it
@@ -97,7 +151,7 @@ static void *lfu_promote(base_cache_t *cache, local_node_t found) {
 //============================================================================================================
 
 static void *lfu_insert_or_replace(base_cache_t *cache, void *index) {
-    void *page = (cache->slow_get ? cache->slow_get(index) : NULL);
+    void *page = base_cache_load(cache, index);
     local_node_t toinsert = NULL;
     char *curr_data_ptr = NULL;
 
@@ -109,47 +163,124 @@ static void *lfu_insert_or_replace(base_cache_t *cache, void *index) {
 
     // 2.1 In this case cache is not full and we can just insert the node with frequency 1.
     if (cache->curr_top < cache->size) {
-        curr_data_ptr = (cache->cached_data + cache->data_size * cache->curr_top++);
+        toinsert = base_cache_new_slot(cache, &curr_data_ptr);
 
-        freq_node_t first_freq = next_freq_node_init(cache->freq_list, NULL);
+        freq_node_t first_freq = next_freq_node_init(cache, NULL);
         if (cache->data_size) {
             local_data.cached = curr_data_ptr;
         }
 
         local_data.root_node = first_freq;
-        toinsert = local_node_init(local_data);
-        base_cache_insert(cache, first_freq, toinsert, local_data, NULL);
+        base_cache_insert(cache, first_freq, toinsert, local_data);
     }
 
     // 2.2 In this case the cache is full and we decide which entry to invalidate and evict based on LFU strategy
     else {
+        // Every entry is pinned, so there is nothing to evict
+        if (dl_list_is_empty(cache->freq_list)) {
+            return base_cache_reject(cache, page);
+        }
+
         freq_node_t first_freq = dl_list_get_first(cache->freq_list);
         local_node_t toevict = dl_list_get_last(freq_node_get_local(first_freq));
 
         local_node_data_t evicted_data = local_node_get_fam(toevict);
-        local_data.cached = evicted_data.cached;
+        local_data.cached = base_cache_replace_page(cache, evicted_data.cached);
         curr_data_ptr = local_data.cached;
 
-        entry_t *free_entry = base_cache_remove(cache, toevict, &evicted_data.index);
+        // The slot of the evicted entry is reused for the new one
+        base_cache_remove(cache, toevict);
 
-        first_freq = next_freq_node_init(cache->freq_list, NULL);
+        first_freq = next_freq_node_init(cache, NULL);
 
         local_data.root_node = first_freq;
-        toinsert = local_node_init(local_data);
-        local_node_free(toevict);
+        toinsert = toevict;
+        base_cache_insert(cache, first_freq, toinsert, local_data);
+    }
 
-        base_cache_insert(cache, first_freq, toinsert, local_data, free_entry);
+    return base_cache_store(cache, toinsert, page);
+}
+
+//============================================================================================================
+
+static void *lfu_insert_sized(base_cache_t *cache, void *index, size_t *length) {
+    void *page = cache->sized_get(index, length);
+
+    // The page would not fit even into the empty cache
+    if (!base_cache_fits(cache, *length)) {
+        return page;
     }
 
-    if (cache->data_size) {
-        memcpy(curr_data_ptr, page, cache->data_size);
+    // Evict least frequently used entries, until there is room both for a slot and for the page in the slab
+    while (base_cache_is_full(cache, *length)) {
+        // The rest of the cache is pinned
+        if (dl_list_is_empty(cache->freq_list)) {
+            return base_cache_reject(cache, page);
+        }
+
+        freq_node_t first_freq = dl_list_get_first(cache->freq_list);
+        base_cache_evict_sized(cache, dl_list_get_last(freq_node_get_local(first_freq)));
     }
 
+    local_node_data_t local_data = {0};
+    local_data.frequency = 1;
+    local_data.index = index;
+    local_data.root_node = next_freq_node_init(cache, NULL);
+    base_cache_store_sized(cache, &local_data, page, *length);
+
+    local_node_t toinsert = base_cache_node_init(cache);
+    base_cache_insert(cache, local_data.root_node, toinsert, local_data);
+    cache->curr_top += 1;
+
     return page;
 }
 
 //============================================================================================================
 
+static void *lfu_get_entry_impl(base_cache_t *cache, void *index, local_node_t found) {
+    if (cache->sketch) {
+        base_cache_record(cache, index);
+    }
+
+    // 1. There is already a cache entry, then we promote it and move futher along the frequency list
+    if (found) {
+        return lfu_promote(cache, found);
+    }
+
+    // Caches that are populated only by puts do not insert anything on misses
+    if (!base_cache_can_load(cache)) {
+        return NULL;
+    }
+
+    // 2. If we get here, then the key is not present in the cache. In this case we call slow_get if it is provided and
+    // insert the key into the cache, while optionally copying the data. There are 2 subcases here: 2.2 and 2.3
+    if (cache->slab) {
+        size_t length = 0;
+        return lfu_insert_sized(cache, index, &length);
+    }
+
+    if (cache->sketch) {
+        return base_cache_admit_miss(cache, index, &lfu_policy);
+    }
+
+    return lfu_insert_or_replace(cache, index);
+}
+
+//============================================================================================================
+
+void *lfu_get_impl(base_cache_t *cache, void *index, local_node_t found) {
+    // After the capacity has been reduced, every get evicts a few more entries until the cache fits again. This is done
+    // before the get, so that its own entry is not evicted and its page is not freed, and found is looked up again
+    if (base_cache_over_capacity(cache)) {
+        base_cache_shrink(cache, &lfu_policy);
+        found = (found ? base_cache_lookup(cache, &index) : NULL);
+    }
+
+    return lfu_get_entry_impl(cache, index, found);
+}
+
+//============================================================================================================
+
 void *lfu_get(lfu_t cache_, void *index) {
     // In this case strict-aliasing does not apply, because base_cache_t is the first member of lfu_s struct
     base_cache_t *cache = (base_cache_t *)cache_;
@@ -157,16 +288,194 @@ void *lfu_get(lfu_t cache_, void *index) {
     assert(cache);
     assert(index);
 
+    return lfu_get_impl(cache, index, base_cache_lookup(cache, &index));
+}
+
+//============================================================================================================
+
+void *lfu_get_sized(lfu_t cache_, void *index, size_t *length) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+    assert(length);
+
     local_node_t found = base_cache_lookup(cache, &index);
 
-    // 1. There is already a cache entry, then we promote it and move futher along the frequency list
+    if (!cache->slab) {
+        *length = cache->data_size;
+        return lfu_get_impl(cache, index, found);
+    }
+
     if (found) {
+        *length = local_node_get_data(found).size;
         return lfu_promote(cache, found);
     }
 
-    // 2. If we get here, then the key is not present in the cache. In this case we call slow_get if it is provided and
-    // insert the key into the cache, while optionally copying the data. There are 2 subcases here: 2.2 and 2.3
-    return lfu_insert_or_replace(cache, index);
+    return lfu_insert_sized(cache, index, length);
+}
+
+//============================================================================================================
+
+int lfu_get_async(lfu_t cache_, void *index, cache_callback_t callback, void *ctx) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return base_cache_get_async(cache, index, callback, ctx, lfu_get_impl);
+}
+
+//============================================================================================================
+
+void lfu_complete_load(lfu_t cache_, void *index, void *page) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    base_cache_complete_load(cache, index, page, lfu_get_impl);
+}
+
+//============================================================================================================
+
+int lfu_put(lfu_t cache_, void *index, void *page) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+    assert(page || !cache->data_size);
+
+    return base_cache_put(cache, index, page, lfu_get_impl);
+}
+
+//============================================================================================================
+
+void *lfu_peek(lfu_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return base_cache_peek(cache, index);
+}
+
+//============================================================================================================
+
+int lfu_contains(lfu_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return (base_cache_lookup(cache, &index) != NULL);
+}
+
+//============================================================================================================
+
+int lfu_erase(lfu_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    int erased = base_cache_erase(cache, index);
+
+    // Erases continue shrinking the same way as gets do
+    if (base_cache_over_capacity(cache)) {
+        base_cache_shrink(cache, &lfu_policy);
+    }
+
+    return erased;
+}
+
+//============================================================================================================
+
+void *lfu_pin(lfu_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return base_cache_pin(cache, index, lfu_get_impl);
+}
+
+//============================================================================================================
+
+void lfu_unpin(lfu_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    base_cache_unpin(cache, index, &lfu_policy);
+
+    // The unpinned entry can be evicted again, which shrinking may have been waiting for
+    if (base_cache_over_capacity(cache)) {
+        base_cache_shrink(cache, &lfu_policy);
+    }
+}
+
+//============================================================================================================
+
+size_t lfu_get_rejected(lfu_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->rejected;
+}
+
+//============================================================================================================
+
+void lfu_set_capacity(lfu_t cache_, size_t size) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    base_cache_set_capacity(cache, size);
+}
+
+//============================================================================================================
+
+int lfu_shrink(lfu_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return base_cache_shrink(cache, &lfu_policy);
+}
+
+//============================================================================================================
+
+size_t lfu_read_begin(lfu_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(cache->epoch);
+
+    return epoch_read_begin(cache->epoch);
+}
+
+//============================================================================================================
+
+void lfu_read_end(lfu_t cache_, size_t guard) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(cache->epoch);
+
+    epoch_read_end(cache->epoch, guard);
+}
+
+//============================================================================================================
+
+void lfu_get_many(lfu_t cache_, void **indices, void **results, size_t count) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    base_cache_get_many(cache, indices, results, count, lfu_get_impl);
 }
 
 //============================================================================================================
@@ -181,6 +490,16 @@ size_t lfu_get_hits(lfu_t cache_) {
 
 //============================================================================================================
 
+size_t lfu_get_used(lfu_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->used;
+}
+
+//============================================================================================================
+
 void lfu_free(lfu_t cache_) {
     base_cache_t *cache = (base_cache_t *)cache_;
 
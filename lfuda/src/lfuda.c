@@ -10,42 +10,48 @@
 #include "lfuda.h"
 #include "basecache.h"
 #include "clist.h"
-#include "rbtree.h"
+#include "policies.h"
 
 #include "memutil.h"
 #include <assert.h>
 
 //============================================================================================================
+// Frequency nodes are kept in the frequency list in ascending order of keys. A new key is always age + frequency and
+// age only grows, so the node for it is found by walking the list forward from a node with a smaller key (finger
+// search) instead of searching a tree. The walk starts either from the current node of the entry or from the head of
+// the list, because all keys are at least age. It passes only distinct keys between the start and the new key, which
+// is at most min(frequency, growth of age since the previous access of the entry) + 1 nodes
+//
+// Keys are compared at full width, and when age reaches the renormalisation threshold every key is shifted down
+// together with age, so the order of the entries is kept and keys can't overflow in a long-running cache
 struct lfuda_s {
     base_cache_t base;
-    rb_tree_t rbtree;
     size_t age;
+    size_t renormalize;
 };
 
-typedef struct {
-    size_t key;
-    freq_node_t freq_node;
-} rb_entry_t;
-
 //============================================================================================================
 
-rb_entry_t *rb_entry_init(size_t key, freq_node_t freq_node) {
-    rb_entry_t *entry = calloc_checked(1, sizeof(rb_entry_t));
+// Shift age and keys of all frequency nodes by the same amount, so that age becomes equal to newage
 
-    entry->freq_node = freq_node;
-    entry->key = key;
+static void lfuda_shift_age(struct lfuda_s *lfuda, size_t newage) {
+    assert(lfuda);
 
-    return entry;
+    base_cache_shift_keys(&lfuda->base, lfuda->age, newage);
+    lfuda->age = newage;
 }
 
 //============================================================================================================
 
-// Reinterpret rb_entry_t as size_t
-int rb_entry_cmp(void *node1_, void *node2_) {
-    assert(node1_);
-    assert(node2_);
-    size_t key1 = *(size_t *)node1_, key2 = *(size_t *)node2_;
-    return (int)key1 - (int)key2;
+// Set age to the key of the evicted entry, renormalising keys if it becomes too large
+
+static void lfuda_evicted_age(struct lfuda_s *lfuda, size_t key) {
+    assert(lfuda);
+
+    lfuda->age = key;
+    if (lfuda->renormalize && lfuda->age >= lfuda->renormalize) {
+        lfuda_shift_age(lfuda, 0);
+    }
 }
 
 //============================================================================================================
@@ -60,78 +66,58 @@ static size_t lfuda_get_next_key(struct lfuda_s *cache, size_t freq) {
 
 //============================================================================================================
 
-// Remove freq node from the freq list and from the red black tree if local list of this freq node is empty
+// Returns the freq node with key, creating it if there is none. The search starts after the node from, which must have
+// a smaller key, or from the head of the frequency list if from is NULL
 
-static inline void lfuda_remove_freq_if_empty(struct lfuda_s *lfuda, freq_node_t root_node) {
+static freq_node_t lfuda_freq_node_find_or_init(struct lfuda_s *lfuda, freq_node_t from, size_t key) {
     assert(lfuda);
-    assert(root_node);
-
-    local_list_t local_list = freq_node_get_local(root_node);
-    int freq_key = freq_node_get_key(root_node);
 
-    if (dl_list_is_empty(local_list)) {
-        rb_entry_t *entry = rb_tree_remove(lfuda->rbtree, &freq_key);
-        free(entry);
-        local_list_free(local_list);
-        freq_node_free(dl_list_remove(lfuda->base.freq_list, root_node));
-    }
-}
+    // In this case strict-aliasing does not apply, because base_cache_t is the first member of lfuda_s struct
+    base_cache_t *basecache = &lfuda->base;
 
-//============================================================================================================
+    assert(!from || freq_node_get_key(from) < key);
 
-// Remove local node from the cache
+    freq_node_t prev = from;
+    freq_node_t next = (from ? dl_node_get_next(from) : dl_list_get_first(basecache->freq_list));
 
-static entry_t *lfuda_remove(base_cache_t *cache, local_node_t node, void **index) {
-    assert(cache);
-    assert(node);
+    while (next && freq_node_get_key(next) < key) {
+        prev = next;
+        next = dl_node_get_next(next);
+    }
 
-    // Index should correspond to the local node
-    entry_t *free_entry = hashtab_remove(cache->table, index);
+    if (next && freq_node_get_key(next) == key) {
+        return next;
+    }
 
-    freq_node_t freq_node = local_node_get_freq_node(node);
-    local_list_t local_list = freq_node_get_local(freq_node);
-    dl_list_remove(local_list, node);
+    freq_node_t new_freq_node = freq_node_init(basecache->freq_pool, key);
 
-    // If list becomes empty, then free it and remove it
-    lfuda_remove_freq_if_empty(cache, freq_node);
+    if (!prev) {
+        dl_list_push_front(basecache->freq_list, new_freq_node);
+    } else {
+        dl_list_insert_after(basecache->freq_list, prev, new_freq_node);
+    }
 
-    return free_entry;
+    return new_freq_node;
 }
 
 //============================================================================================================
 
-// Returns the freq node to insert localnode into
+// Returns the freq node to move localnode into, while it is still in its current freq node
 
 static freq_node_t lfuda_next_freq_node_init(struct lfuda_s *lfuda, local_node_t localnode) {
     assert(lfuda);
     assert(localnode);
 
     local_node_data_t local_data = local_node_get_data(localnode);
-
-    // In this case strict-aliasing does not apply, because base_cache_t is the first member of lfuda_s struct
-    base_cache_t *basecache = &lfuda->base;
+    freq_node_t root_node = local_data.root_node;
 
     size_t nextkey = lfuda_get_next_key(lfuda, local_data.frequency);
-    rb_entry_t *next_freq = rb_tree_closest_left(lfuda->rbtree, &nextkey);
-
-    if (!next_freq) {
-        freq_node_t new_freq_node = freq_node_init(nextkey);
-        rb_tree_insert(lfuda->rbtree, rb_entry_init(nextkey, new_freq_node));
-        dl_list_push_front(basecache->freq_list, new_freq_node);
-        return new_freq_node;
-    }
-
-    freq_node_t next_freq_node = next_freq->freq_node;
-    if (next_freq->key == nextkey) {
-        return next_freq_node;
-    }
-
-    freq_node_t new_freq_node = freq_node_init(nextkey);
+    size_t rootkey = freq_node_get_key(root_node);
 
-    rb_tree_insert(lfuda->rbtree, rb_entry_init(nextkey, new_freq_node));
-    dl_list_insert_after(basecache->freq_list, next_freq_node, new_freq_node);
+    // Start from the one of the current node and the head, which is closer by key
+    freq_node_t from = (nextkey - lfuda->age < nextkey - rootkey ? NULL : root_node);
 
-    return new_freq_node;
+    return lfuda_freq_node_find_or_init(lfuda, from, nextkey);
 }
 
 //============================================================================================================
@@ -140,9 +126,8 @@ lfuda_t lfuda_init(cache_init_t init) {
     struct lfuda_s *lfuda = calloc_checked(1, sizeof(struct lfuda_s));
 
     base_cache_init(&lfuda->base, init);
-
-    lfuda->rbtree = rb_tree_init(RBTREE_CMP_F(rb_entry_cmp));
     lfuda->age = 0;
+    lfuda->renormalize = BASE_CACHE_RENORMALIZE_DEFAULT;
 
     return lfuda;
 }
@@ -154,8 +139,6 @@ void lfuda_free(lfuda_t cache_) {
 
     base_cache_free(&lfuda->base);
 
-    rb_tree_free(lfuda->rbtree, free);
-
     free(lfuda);
 }
 
@@ -163,44 +146,60 @@ void lfuda_free(lfuda_t cache_) {
 
 // Returns the freq node for inserting new local node
 
-freq_node_t lfuda_first_freq_node_init(struct lfuda_s *lfuda) {
+static freq_node_t lfuda_first_freq_node_init(struct lfuda_s *lfuda) {
     assert(lfuda);
-    struct base_cache_s *basecache = &lfuda->base;
-
-    // Get first node of the frequency list
-    freq_node_t first_freq = dl_list_get_first(basecache->freq_list);
-    size_t first_freq_key = lfuda->age + 1;
 
     // When a new object is added, its key should be set to cache's age
+    size_t first_freq_key = lfuda_get_next_key(lfuda, 1);
 
-    // create new freq node and insert it in a red-black tree
-    freq_node_t new_freq_node = freq_node_init(first_freq_key);
-    rb_entry_t *next_freq = rb_tree_closest_left(lfuda->rbtree, &first_freq_key);
+    // All keys are at least age, so the node is at the head of the list
+    return lfuda_freq_node_find_or_init(lfuda, NULL, first_freq_key);
+}
 
-    if (!next_freq) {
-        rb_tree_insert(lfuda->rbtree, rb_entry_init(first_freq_key, new_freq_node));
-        dl_list_push_front(basecache->freq_list, new_freq_node);
-        return new_freq_node;
-    }
+//============================================================================================================
 
-    freq_node_t next_freq_node = next_freq->freq_node;
-    if (next_freq->key == first_freq_key) {
-        local_list_free(freq_node_get_local(new_freq_node));
-        freq_node_free(new_freq_node);
-        return next_freq_node;
-    }
+// Admission steps of the policy: entries entering the cache get the key of a new entry, and age is set to the key of
+// the evicted one
 
-    rb_tree_insert(lfuda->rbtree, rb_entry_init(first_freq_key, new_freq_node));
-    dl_list_insert_after(basecache->freq_list, next_freq_node, new_freq_node);
+static freq_node_t lfuda_policy_first_freq(base_cache_t *basecache) {
+    return lfuda_first_freq_node_init((struct lfuda_s *)basecache);
+}
 
-    return new_freq_node;
+static void lfuda_policy_evict(base_cache_t *basecache, size_t key) {
+    lfuda_evicted_age((struct lfuda_s *)basecache, key);
+}
+
+// Entries that are unpinned get the key of an access with the frequency they have got so far. The search starts at the
+// node they were pinned from, unless age has not grown past it or the node has been reused for a larger key
+static freq_node_t lfuda_policy_find_freq(base_cache_t *basecache, freq_node_t from, size_t frequency) {
+    struct lfuda_s *lfuda = (struct lfuda_s *)basecache;
+    size_t key = lfuda_get_next_key(lfuda, frequency);
+
+    if (from && freq_node_get_key(from) == key) {
+        return from;
+    }
+    from = (from && freq_node_get_key(from) < key ? from : NULL);
+
+    return lfuda_freq_node_find_or_init(lfuda, from, key);
 }
 
+static const base_cache_policy_t lfuda_policy = {lfuda_policy_first_freq, lfuda_policy_evict, lfuda_policy_find_freq};
+
 //============================================================================================================
 
 static void *lfuda_get_case_found_impl(struct lfuda_s *lfuda, local_node_t found) {
     struct base_cache_s *basecache = &lfuda->base;
 
+    // Pinned entries are off the frequency list until they are unpinned
+    if (base_cache_is_pinned(basecache, found)) {
+        return base_cache_pinned_hit(basecache, found);
+    }
+
+    // Entries in the admission window are only reordered
+    if (base_cache_in_window(basecache, found)) {
+        return base_cache_window_hit(basecache, found);
+    }
+
     // Increment cache hits
     basecache->hits += 1;
 
@@ -211,14 +210,15 @@ static void *lfuda_get_case_found_impl(struct lfuda_s *lfuda, local_node_t found
     // Increment frequency of the found cache entry
     local_data.frequency += 1;
 
+    // Find next freq node (or create it) while the current one is still in the list to start the search from
+    local_node_set_data(found, local_data);
+    freq_node_t next_freq = lfuda_next_freq_node_init(lfuda, found);
+
     // Remove local node from this local list and move to the local list
     // with another key (not just incremented)
     local_list_t local_list = root_node_data.local_list;
     dl_list_remove(local_list, found);
-    lfuda_remove_freq_if_empty(lfuda, root_node);
-    // Find next freq node (or create it)
-    local_node_set_data(found, local_data);
-    freq_node_t next_freq = lfuda_next_freq_node_init(lfuda, found);
+    base_cache_remove_freq_if_empty(basecache, root_node);
     dl_list_push_front(freq_node_get_local(next_freq), found);
 
     local_data.root_node = next_freq;
@@ -232,14 +232,12 @@ static void *lfuda_get_case_found_impl(struct lfuda_s *lfuda, local_node_t found
 static void *lfuda_get_case_is_not_full_impl(struct lfuda_s *lfuda, void *index) {
     struct base_cache_s *basecache = &lfuda->base;
 
-    void *page = (basecache->slow_get ? basecache->slow_get(index) : NULL);
+    void *page = base_cache_load(basecache, index);
     local_node_t toinsert = NULL;
     char *curr_data_ptr = NULL;
 
-    // Set current data pointer
-    curr_data_ptr = basecache->cached_data + basecache->data_size * basecache->curr_top;
-    // Increment curr_top
-    basecache->curr_top += 1;
+    // Take a free slot together with its data pointer
+    toinsert = base_cache_new_slot(basecache, &curr_data_ptr);
 
     // Intialize local_data with current information
     local_node_data_t local_data = {0};
@@ -251,16 +249,11 @@ static void *lfuda_get_case_is_not_full_impl(struct lfuda_s *lfuda, void *index)
         local_data.cached = curr_data_ptr;
     }
 
-    toinsert = local_node_init(local_data);
     local_data.root_node = first_freq;
 
-    base_cache_insert(basecache, first_freq, toinsert, local_data, NULL);
+    base_cache_insert(basecache, first_freq, toinsert, local_data);
 
-    if (basecache->data_size) {
-        memcpy(curr_data_ptr, page, basecache->data_size);
-    }
-
-    return page;
+    return base_cache_store(basecache, toinsert, page);
 }
 
 //============================================================================================================
@@ -268,7 +261,7 @@ static void *lfuda_get_case_is_not_full_impl(struct lfuda_s *lfuda, void *index)
 static void *lfuda_get_case_full_impl(struct lfuda_s *lfuda, void *index) {
     struct base_cache_s *basecache = &lfuda->base;
 
-    void *page = (basecache->slow_get ? basecache->slow_get(index) : NULL);
+    void *page = base_cache_load(basecache, index);
     char *curr_data_ptr = NULL;
 
     // Intialize local_data with current information
@@ -276,6 +269,11 @@ static void *lfuda_get_case_full_impl(struct lfuda_s *lfuda, void *index) {
     local_data.frequency = 1;
     local_data.index = index;
 
+    // Every entry is pinned, so there is nothing to evict
+    if (dl_list_is_empty(basecache->freq_list)) {
+        return base_cache_reject(basecache, page);
+    }
+
     // Get first node of frequency list
     // (according to the LFU-DA policy we must evict entry with lowest freq)
     freq_node_t first_freq = dl_list_get_first(basecache->freq_list);
@@ -286,45 +284,93 @@ static void *lfuda_get_case_full_impl(struct lfuda_s *lfuda, void *index) {
     local_node_t toevict = dl_list_get_last(first_freq_data.local_list);
     local_node_data_t evicted_data = local_node_get_data(toevict);
 
-    lfuda->age = freq_node_get_key(evicted_data.root_node);
-    curr_data_ptr = local_data.cached = evicted_data.cached;
+    lfuda_evicted_age(lfuda, freq_node_get_key(evicted_data.root_node));
+    curr_data_ptr = base_cache_replace_page(basecache, evicted_data.cached);
 
     freq_node_t next_freq = lfuda_first_freq_node_init(lfuda);
-    entry_t *free_entry = lfuda_remove(basecache, toevict, &evicted_data.index);
-    local_node_set_data(toevict, local_data);
+    // The slot of the evicted entry is reused for the new one
+    base_cache_remove(basecache, toevict);
 
     local_data.root_node = next_freq;
-    local_data.cached = evicted_data.cached;
+    local_data.cached = curr_data_ptr;
 
-    base_cache_insert(basecache, next_freq, toevict, local_data, free_entry);
+    base_cache_insert(basecache, next_freq, toevict, local_data);
 
-    if (basecache->data_size) {
-        memcpy(curr_data_ptr, page, basecache->data_size);
+    return base_cache_store(basecache, toevict, page);
+}
+
+//============================================================================================================
+
+static void *lfuda_get_case_sized_impl(struct lfuda_s *lfuda, void *index, size_t *length) {
+    struct base_cache_s *basecache = &lfuda->base;
+
+    void *page = basecache->sized_get(index, length);
+
+    // The page would not fit even into the empty cache
+    if (!base_cache_fits(basecache, *length)) {
+        return page;
     }
 
+    // Evict entries with the lowest keys, until there is room both for a slot and for the page in the slab
+    while (base_cache_is_full(basecache, *length)) {
+        // The rest of the cache is pinned
+        if (dl_list_is_empty(basecache->freq_list)) {
+            return base_cache_reject(basecache, page);
+        }
+
+        freq_node_t first_freq = dl_list_get_first(basecache->freq_list);
+        local_node_t toevict = dl_list_get_last(freq_node_get_local(first_freq));
+
+        lfuda_evicted_age(lfuda, freq_node_get_key(first_freq));
+        base_cache_evict_sized(basecache, toevict);
+    }
+
+    local_node_data_t local_data = {0};
+    local_data.frequency = 1;
+    local_data.index = index;
+    local_data.root_node = lfuda_first_freq_node_init(lfuda);
+    base_cache_store_sized(basecache, &local_data, page, *length);
+
+    local_node_t toinsert = base_cache_node_init(basecache);
+    base_cache_insert(basecache, local_data.root_node, toinsert, local_data);
+    basecache->curr_top += 1;
+
     return page;
 }
 
 //============================================================================================================
 
-void *lfuda_get(lfuda_t cache_, void *index) {
-    struct lfuda_s *lfuda = (struct lfuda_s *)cache_;
+static void *lfuda_get_entry_impl(base_cache_t *basecache, void *index, local_node_t found) {
     // In this case strict-aliasing does not apply, because base_cache_t is the first member of lfuda_s struct
-    struct base_cache_s *basecache = &lfuda->base;
+    struct lfuda_s *lfuda = (struct lfuda_s *)basecache;
 
-    assert(lfuda);
-    assert(index);
-
-    local_node_t found = base_cache_lookup(basecache, &index);
+    if (basecache->sketch) {
+        base_cache_record(basecache, index);
+    }
 
     // 1. There is already a cache entry, then we promote it and move futher along the frequency list
     if (found) {
-        return lfuda_get_case_found_impl(cache_, found);
+        return lfuda_get_case_found_impl(lfuda, found);
     }
 
     // If we get here, then the key is not present in the cache. In this case we call slow_get if it is
     // provided and insert the key into the cache, while optionally copying the data.
 
+    // Caches that are populated only by puts do not insert anything on misses
+    if (!base_cache_can_load(basecache)) {
+        return NULL;
+    }
+
+    // Pages of variable length are evicted and stored in their own way
+    if (basecache->slab) {
+        size_t length = 0;
+        return lfuda_get_case_sized_impl(lfuda, index, &length);
+    }
+
+    if (basecache->sketch) {
+        return base_cache_admit_miss(basecache, index, &lfuda_policy);
+    }
+
     // 2. In this case cache is not full and we can just insert the node with initial frequency
     if (basecache->curr_top < basecache->size) {
         return lfuda_get_case_is_not_full_impl(lfuda, index);
@@ -338,6 +384,217 @@ void *lfuda_get(lfuda_t cache_, void *index) {
 
 //============================================================================================================
 
+void *lfuda_get_impl(base_cache_t *basecache, void *index, local_node_t found) {
+    // After the capacity has been reduced, every get evicts a few more entries until the cache fits again. This is done
+    // before the get, so that its own entry is not evicted and its page is not freed, and found is looked up again
+    if (base_cache_over_capacity(basecache)) {
+        base_cache_shrink(basecache, &lfuda_policy);
+        found = (found ? base_cache_lookup(basecache, &index) : NULL);
+    }
+
+    return lfuda_get_entry_impl(basecache, index, found);
+}
+
+//============================================================================================================
+
+void *lfuda_get(lfuda_t cache_, void *index) {
+    struct lfuda_s *lfuda = (struct lfuda_s *)cache_;
+
+    assert(lfuda);
+    assert(index);
+
+    return lfuda_get_impl(&lfuda->base, index, base_cache_lookup(&lfuda->base, &index));
+}
+
+//============================================================================================================
+
+void *lfuda_get_sized(lfuda_t cache_, void *index, size_t *length) {
+    struct lfuda_s *lfuda = (struct lfuda_s *)cache_;
+
+    assert(lfuda);
+    assert(index);
+    assert(length);
+
+    local_node_t found = base_cache_lookup(&lfuda->base, &index);
+
+    if (!lfuda->base.slab) {
+        *length = lfuda->base.data_size;
+        return lfuda_get_impl(&lfuda->base, index, found);
+    }
+
+    if (found) {
+        *length = local_node_get_data(found).size;
+        return lfuda_get_case_found_impl(lfuda, found);
+    }
+
+    return lfuda_get_case_sized_impl(lfuda, index, length);
+}
+
+//============================================================================================================
+
+int lfuda_get_async(lfuda_t cache_, void *index, cache_callback_t callback, void *ctx) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return base_cache_get_async(cache, index, callback, ctx, lfuda_get_impl);
+}
+
+//============================================================================================================
+
+void lfuda_complete_load(lfuda_t cache_, void *index, void *page) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    base_cache_complete_load(cache, index, page, lfuda_get_impl);
+}
+
+//============================================================================================================
+
+int lfuda_put(lfuda_t cache_, void *index, void *page) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+    assert(page || !cache->data_size);
+
+    return base_cache_put(cache, index, page, lfuda_get_impl);
+}
+
+//============================================================================================================
+
+void *lfuda_peek(lfuda_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return base_cache_peek(cache, index);
+}
+
+//============================================================================================================
+
+int lfuda_contains(lfuda_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return (base_cache_lookup(cache, &index) != NULL);
+}
+
+//============================================================================================================
+
+int lfuda_erase(lfuda_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    int erased = base_cache_erase(cache, index);
+
+    // Erases continue shrinking the same way as gets do
+    if (base_cache_over_capacity(cache)) {
+        base_cache_shrink(cache, &lfuda_policy);
+    }
+
+    return erased;
+}
+
+//============================================================================================================
+
+void *lfuda_pin(lfuda_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    return base_cache_pin(cache, index, lfuda_get_impl);
+}
+
+//============================================================================================================
+
+void lfuda_unpin(lfuda_t cache_, void *index) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(index);
+
+    base_cache_unpin(cache, index, &lfuda_policy);
+
+    // The unpinned entry can be evicted again, which shrinking may have been waiting for
+    if (base_cache_over_capacity(cache)) {
+        base_cache_shrink(cache, &lfuda_policy);
+    }
+}
+
+//============================================================================================================
+
+size_t lfuda_get_rejected(lfuda_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->rejected;
+}
+
+//============================================================================================================
+
+void lfuda_set_capacity(lfuda_t cache_, size_t size) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    base_cache_set_capacity(cache, size);
+}
+
+//============================================================================================================
+
+int lfuda_shrink(lfuda_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return base_cache_shrink(cache, &lfuda_policy);
+}
+
+//============================================================================================================
+
+size_t lfuda_read_begin(lfuda_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(cache->epoch);
+
+    return epoch_read_begin(cache->epoch);
+}
+
+//============================================================================================================
+
+void lfuda_read_end(lfuda_t cache_, size_t guard) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+    assert(cache->epoch);
+
+    epoch_read_end(cache->epoch, guard);
+}
+
+//============================================================================================================
+
+void lfuda_get_many(lfuda_t cache_, void **indices, void **results, size_t count) {
+    struct lfuda_s *lfuda = (struct lfuda_s *)cache_;
+
+    assert(lfuda);
+
+    base_cache_get_many(&lfuda->base, indices, results, count, lfuda_get_impl);
+}
+
+//============================================================================================================
+
 size_t lfuda_get_hits(lfuda_t cache_) {
     // In this case strict-aliasing does not apply, because base_cache_t is the first member of lfuda_s struct
     base_cache_t *cache = (base_cache_t *)cache_;
@@ -347,10 +604,43 @@ size_t lfuda_get_hits(lfuda_t cache_) {
     return cache->hits;
 }
 
+//============================================================================================================
+
+size_t lfuda_get_used(lfuda_t cache_) {
+    // In this case strict-aliasing does not apply, because base_cache_t is the first member of lfuda_s struct
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->used;
+}
+
+//============================================================================================================
+
 size_t lfuda_get_age(lfuda_t cache_) {
     struct lfuda_s *cache = (struct lfuda_s *)cache_;
 
     assert(cache);
 
     return cache->age;
-}
\ No newline at end of file
+}
+
+//============================================================================================================
+
+void lfuda_set_age(lfuda_t cache_, size_t age) {
+    struct lfuda_s *cache = (struct lfuda_s *)cache_;
+
+    assert(cache);
+
+    lfuda_shift_age(cache, age);
+}
+
+//============================================================================================================
+
+void lfuda_set_renormalize(lfuda_t cache_, size_t threshold) {
+    struct lfuda_s *cache = (struct lfuda_s *)cache_;
+
+    assert(cache);
+
+    cache->renormalize = threshold;
+}
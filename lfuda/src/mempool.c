@@ -0,0 +1,154 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "mempool.h"
+
+#include "memutil.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+//============================================================================================================
+
+// Free objects store the pointer to the next free object in their first bytes
+typedef struct free_obj_s {
+    struct free_obj_s *next;
+} free_obj_t;
+
+// Chunks are chained to be freed together with the pool. Objects follow the header
+typedef struct chunk_s {
+    struct chunk_s *next;
+    size_t count;
+} chunk_t;
+
+struct mempool_s {
+    size_t obj_size;
+    size_t chunk_count;
+    // Objects that can be allocated, both on the free list and not carved out of the last chunk yet
+    size_t free_count;
+
+    free_obj_t *free_list;
+    chunk_t *chunks;
+
+    // Objects of the last chunk are carved out one by one, so that adding a chunk does not touch all of its objects
+    char *unused;
+    size_t unused_count;
+};
+
+//============================================================================================================
+
+// Round object size up, so that every object in a chunk is aligned at least as the header and can hold a free list link
+static inline size_t mempool_align_size(size_t size) {
+    const size_t align = sizeof(free_obj_t) > sizeof(chunk_t) ? sizeof(free_obj_t) : sizeof(chunk_t);
+    size = (size < sizeof(free_obj_t) ? sizeof(free_obj_t) : size);
+    return (size + align - 1) / align * align;
+}
+
+//============================================================================================================
+
+static void mempool_add_chunk(struct mempool_s *pool, size_t count) {
+    assert(pool);
+    assert(count);
+
+    chunk_t *chunk = calloc_checked(1, mempool_align_size(sizeof(chunk_t)) + count * pool->obj_size);
+    chunk->count = count;
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+
+    // Objects left in the previous chunk go to the free list, which only happens when the pool is reserved
+    for (; pool->unused_count; pool->unused_count--, pool->unused += pool->obj_size) {
+        free_obj_t *obj = (free_obj_t *)pool->unused;
+        obj->next = pool->free_list;
+        pool->free_list = obj;
+    }
+
+    // Objects are carved out in order, so that they get allocated sequentially
+    pool->unused = (char *)chunk + mempool_align_size(sizeof(chunk_t));
+    pool->unused_count = count;
+    pool->free_count += count;
+}
+
+//============================================================================================================
+
+mempool_t *mempool_init(size_t obj_size, size_t count) {
+    assert(obj_size);
+
+    struct mempool_s *pool = calloc_checked(1, sizeof(struct mempool_s));
+    pool->obj_size = mempool_align_size(obj_size);
+    pool->chunk_count = (count ? count : 1);
+
+    if (count) {
+        mempool_add_chunk(pool, count);
+    }
+
+    return pool;
+}
+
+//============================================================================================================
+
+void mempool_free(mempool_t *pool) {
+    assert(pool);
+
+    chunk_t *chunk = pool->chunks;
+    while (chunk) {
+        chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(pool);
+}
+
+//============================================================================================================
+
+void *mempool_alloc(mempool_t *pool) {
+    assert(pool);
+
+    // The pool has run out of objects. Grow it geometrically, so that the number of chunks stays logarithmic
+    if (!pool->free_list && !pool->unused_count) {
+        mempool_add_chunk(pool, pool->chunk_count);
+        pool->chunk_count *= 2;
+    }
+
+    free_obj_t *obj = pool->free_list;
+    if (obj) {
+        pool->free_list = obj->next;
+    } else {
+        obj = (free_obj_t *)pool->unused;
+        pool->unused += pool->obj_size;
+        pool->unused_count--;
+    }
+    pool->free_count--;
+
+    memset(obj, 0, pool->obj_size);
+    return obj;
+}
+
+//============================================================================================================
+
+void mempool_release(mempool_t *pool, void *obj_) {
+    assert(pool);
+    assert(obj_);
+
+    free_obj_t *obj = (free_obj_t *)obj_;
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+    pool->free_count++;
+}
+
+//============================================================================================================
+
+void mempool_reserve(mempool_t *pool, size_t count) {
+    assert(pool);
+
+    if (pool->free_count < count) {
+        mempool_add_chunk(pool, count - pool->free_count);
+    }
+}
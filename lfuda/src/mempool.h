@@ -0,0 +1,26 @@
+#ifndef LFUDA_MEMPOOL_H
+#define LFUDA_MEMPOOL_H
+
+#include <stddef.h>
+
+// Pool of fixed size objects with an intrusive free list. Objects are carved out of big chunks, which are allocated at
+// init and only when the pool runs out of free objects, so that steady state operation does not call malloc at all
+struct mempool_s;
+typedef struct mempool_s mempool_t;
+
+// Create a pool for objects of obj_size bytes with count objects preallocated
+mempool_t *mempool_init(size_t obj_size, size_t count);
+
+// Free the pool together with all of the objects allocated from it
+void mempool_free(mempool_t *pool);
+
+// Get zero-initialized object from the pool
+void *mempool_alloc(mempool_t *pool);
+
+// Return object back to the pool it was allocated from
+void mempool_release(mempool_t *pool, void *obj);
+
+// Make sure that at least count objects can be allocated without allocating another chunk
+void mempool_reserve(mempool_t *pool, size_t count);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef LFUDA_POLICIES_H
+#define LFUDA_POLICIES_H
+
+#include "basecache.h"
+
+// Single gets of the policies private to the library files, see base_cache_get_func_t. They let the caches that look up
+// the entries on their own, like the sharded cache, apply the gets later
+void *lfu_get_impl(base_cache_t *cache, void *index, local_node_t found);
+void *lfuda_get_impl(base_cache_t *basecache, void *index, local_node_t found);
+
+#endif
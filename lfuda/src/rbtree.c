@@ -13,6 +13,7 @@
 #include <stdio.h>
 
 #include "error.h"
+#include "mempool.h"
 #include "memutil.h"
 
 #include <assert.h>
@@ -33,12 +34,14 @@ typedef struct rb_node_s {
 struct rb_tree_s {
     rb_cmp_func_t cmp;
     rb_node_t *root;
+    // All nodes of the tree are allocated from this pool
+    mempool_t *pool;
 };
 
 //============================================================================================================
 
-rb_node_t *rb_node_init(enum node_color_e color, void *data) {
-    rb_node_t *node = calloc_checked(1, sizeof(rb_node_t));
+static rb_node_t *rb_node_init(struct rb_tree_s *tree, enum node_color_e color, void *data) {
+    rb_node_t *node = mempool_alloc(tree->pool);
     node->color = color;
     node->data = data;
     return node;
@@ -46,26 +49,20 @@ rb_node_t *rb_node_init(enum node_color_e color, void *data) {
 
 //============================================================================================================
 
+#define RB_TREE_DEFAULT_POOL_SIZE 32
 rb_tree_t rb_tree_init(rb_cmp_func_t cmp) {
     struct rb_tree_s *tree = calloc_checked(1, sizeof(struct rb_tree_s));
     tree->cmp = cmp;
+    tree->pool = mempool_init(sizeof(rb_node_t), RB_TREE_DEFAULT_POOL_SIZE);
     return tree;
 }
 
 //============================================================================================================
 
-static void rb_tree_free_no_data_impl(rb_node_t *root) {
-    assert(root);
-
-    if (root->right) {
-        rb_tree_free_no_data_impl(root->right);
-    }
-
-    if (root->left) {
-        rb_tree_free_no_data_impl(root->left);
-    }
-
-    free(root);
+void rb_tree_reserve(rb_tree_t tree_, size_t count) {
+    struct rb_tree_s *tree = (struct rb_tree_s *)tree_;
+    assert(tree);
+    mempool_reserve(tree->pool, count);
 }
 
 //============================================================================================================
@@ -83,7 +80,6 @@ static void rb_tree_free_data_impl(rb_node_t *root, rb_free_func_t data_free) {
     }
 
     data_free(root->data);
-    free(root);
 }
 
 //============================================================================================================
@@ -91,17 +87,12 @@ static void rb_tree_free_data_impl(rb_node_t *root, rb_free_func_t data_free) {
 void rb_tree_free(rb_tree_t tree_, rb_free_func_t data_free) {
     struct rb_tree_s *tree = (struct rb_tree_s *)tree_;
 
-    if (!tree->root) {
-        free(tree);
-        return;
-    }
-
-    if (data_free) {
+    // Nodes are freed all at once together with the pool, so the tree has to be walked only to free the data
+    if (tree->root && data_free) {
         rb_tree_free_data_impl(tree->root, data_free);
-    } else {
-        rb_tree_free_no_data_impl(tree->root);
     }
 
+    mempool_free(tree->pool);
     free(tree);
 }
 
@@ -168,7 +159,7 @@ static rb_node_t *rb_tree_bst_insert(struct rb_tree_s *tree, void *toinsert, rb_
         }
     }
 
-    node = rb_node_init(COLOR_RED, toinsert);
+    node = rb_node_init(tree, COLOR_RED, toinsert);
     node->parent = prev;
 
     if (!prev) {
@@ -536,8 +527,8 @@ void *rb_tree_remove(rb_tree_t tree_, void *toremove) {
     // 3. Prune the leaf
     prune_leaf(tree, leaf);
 
-    // 4. Free the leaf
-    free(leaf);
+    // 4. Return the leaf to the pool
+    mempool_release(tree->pool, leaf);
 
     return result;
 }
@@ -650,31 +641,24 @@ int rb_tree_is_valid(rb_tree_t tree_) {
 
 //============================================================================================================
 
-static inline int iabs(const int value) {
-    return (value > 0 ? value : -value);
-}
-
-//============================================================================================================
+// Only the sign of cmp is used, so that keys of any width can be compared. Every node on the search path is closer to
+// key than the previous ones on the same side, so the last one on the required side is the closest
 
 const void *rb_tree_closest_left_impl(rb_node_t *root, void *key, rb_cmp_func_t cmp) {
     assert(root);
     assert(key);
 
     void *closest_data = NULL;
-    int closest_diff = INT_MAX;
 
     while (root) {
         int current_diff = cmp(root->data, key);
-        if (current_diff <= 0) {
-            if (iabs(current_diff) < closest_diff) {
-                closest_diff = iabs(current_diff);
-                closest_data = root->data;
-            }
+        if (current_diff == 0) {
+            return root->data;
+        } else if (current_diff < 0) {
+            closest_data = root->data;
             root = root->right;
-        } else if (current_diff > 0) {
-            root = root->left;
         } else {
-            break;
+            root = root->left;
         }
     }
 
@@ -698,20 +682,16 @@ const void *rb_tree_closest_right_impl(rb_node_t *root, void *key, rb_cmp_func_t
     assert(key);
 
     void *closest_data = NULL;
-    int closest_diff = INT_MAX;
 
     while (root) {
         int current_diff = cmp(root->data, key);
-        if (current_diff < 0) {
-            root = root->right;
-        } else if (current_diff >= 0) {
-            if (iabs(current_diff) < closest_diff) {
-                closest_diff = iabs(current_diff);
-                closest_data = root->data;
-            }
+        if (current_diff == 0) {
+            return root->data;
+        } else if (current_diff > 0) {
+            closest_data = root->data;
             root = root->left;
         } else {
-            break;
+            root = root->right;
         }
     }
 
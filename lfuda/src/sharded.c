@@ -0,0 +1,545 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+// Writer-preferring read-write locks of glibc are a GNU extension
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "sharded.h"
+#include "basecache.h"
+#include "lfu.h"
+#include "lfuda.h"
+#include "policies.h"
+
+#include "memutil.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+//============================================================================================================
+
+// Shards and buffers are aligned to cache lines, so that threads that use neighbouring ones do not share lines
+#define SHARDED_CACHE_LINE 64
+
+// Hits only look the entry up under the read lock of the shard and put it into one of the promotion buffers, which are
+// applied under the write lock. Every shard has a buffer per online CPU, rounded up to a power of two, and threads get
+// the buffers in turn, so that threads that run at the same time rarely append to the same one. A buffer that is half
+// full is drained by the thread that gets the write lock without waiting
+#define SHARDED_MAX_BUFFERS 256
+#define SHARDED_BUFFER_SIZE 16
+#define SHARDED_DRAIN_AT    (SHARDED_BUFFER_SIZE / 2)
+
+// Operations of the cache of a single shard
+typedef struct {
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    base_cache_get_func_t get;
+    // Optional, age is 0 for the policies without one
+    size_t (*get_age)(void *cache);
+} sharded_policy_t;
+
+static const sharded_policy_t sharded_lfu_policy = {lfu_init, lfu_free, lfu_get_impl, NULL};
+static const sharded_policy_t sharded_lfuda_policy = {lfuda_init, lfuda_free, lfuda_get_impl, lfuda_get_age};
+
+// Lossy ring buffer of promotions. Readers reserve slots by moving the tail, while the head is only moved by the drain
+// under the write lock, so every reserved slot has been written by the time the buffer is drained
+typedef struct {
+    _Alignas(SHARDED_CACHE_LINE) atomic_size_t tail;
+    size_t head;
+    local_node_t nodes[SHARDED_BUFFER_SIZE];
+} sharded_buffer_t;
+
+typedef struct {
+    _Alignas(SHARDED_CACHE_LINE) pthread_rwlock_t lock;
+    void *cache;
+    // Hits that did not fit into the buffers, they are counted but the entries are not promoted
+    atomic_size_t dropped;
+    sharded_buffer_t *buffers;
+
+    // Loads in flight and the misses that waited for them instead of loading the page again
+    _Alignas(SHARDED_CACHE_LINE) pthread_mutex_t flight_lock;
+    pthread_cond_t flight_done;
+    hashtab_t flights;
+    mempool_t *flight_pool;
+    size_t coalesced;
+} sharded_shard_t;
+
+// Load of a page, which the misses of the same index wait for. Indices are stored the same way as in the cache slots,
+// see base_cache_slot_key, and the page is copied after the index
+typedef struct {
+    struct hashtab_node_s hash_link;
+    void *index;
+    size_t waiters;
+    int done;
+    unsigned char key[];
+} sharded_flight_t;
+
+struct sharded_s {
+    const sharded_policy_t *policy;
+    sharded_shard_t *shards;
+    size_t nshards;
+    // Number of promotion buffers of every shard, a power of two
+    size_t nbuffers;
+
+    // Keys are hashed the same way as in the shards, see base_cache_slot_key
+    hash_func_t hash;
+    size_t key_size;
+    size_t data_size;
+
+    // Loader of the user, the shards get the pages that have been loaded outside of their locks instead
+    cache_get_page_t get;
+    size_t flight_page_offset;
+};
+
+//============================================================================================================
+
+// Page loaded by the thread that holds the write lock of a shard, which the shard gets instead of calling the loader
+static _Thread_local void *sharded_loaded_page;
+
+static void *sharded_get_loaded(void *index) {
+    UNUSED_PARAMETER(index);
+    return sharded_loaded_page;
+}
+
+//============================================================================================================
+
+// Number of promotion buffers of a shard: the number of online CPUs rounded up to a power of two
+static size_t sharded_buffer_count(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    size_t count = 1;
+    while (count < SHARDED_MAX_BUFFERS && (long)count < cpus) {
+        count <<= 1;
+    }
+
+    return count;
+}
+
+//============================================================================================================
+
+// Writers are preferred where the platform supports it, so that a steady stream of hits does not keep the misses and
+// the drains of the shard waiting. Nothing takes the read lock of a shard recursively, which the lock kind requires
+static void sharded_lock_init(pthread_rwlock_t *lock) {
+#ifdef __GLIBC__
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    pthread_rwlock_init(lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+#else
+    pthread_rwlock_init(lock, NULL);
+#endif
+}
+
+//============================================================================================================
+
+static sharded_t sharded_init(cache_init_t init, size_t nshards, const sharded_policy_t *policy) {
+    assert(nshards);
+    assert(init.size >= nshards);
+    assert(!init.get_sized);
+    assert(!init.fill);
+
+    struct sharded_s *sharded = calloc_checked(1, sizeof(struct sharded_s));
+
+    sharded->policy = policy;
+    sharded->nshards = nshards;
+    sharded->nbuffers = sharded_buffer_count();
+    sharded->hash = init.hash;
+    sharded->key_size = init.key_size;
+    sharded->data_size = init.data_size;
+
+    sharded->get = init.get;
+    if (init.get) {
+        init.get = sharded_get_loaded;
+    }
+
+    size_t page_align = _Alignof(max_align_t);
+    sharded->flight_page_offset = (sizeof(sharded_flight_t) + init.key_size + page_align - 1) / page_align * page_align;
+
+    sharded->shards = aligned_alloc(SHARDED_CACHE_LINE, sizeof(sharded_shard_t) * nshards);
+    if (!sharded->shards) {
+        ERROR("Memory exhausted\n");
+    }
+
+    // Entries that do not divide evenly go to the first shards
+    size_t size = init.size;
+    for (size_t i = 0; i < nshards; ++i) {
+        sharded_shard_t *shard = &sharded->shards[i];
+
+        init.size = size / nshards + (i < size % nshards);
+        shard->cache = policy->init(init);
+        sharded_lock_init(&shard->lock);
+
+        pthread_mutex_init(&shard->flight_lock, NULL);
+        pthread_cond_init(&shard->flight_done, NULL);
+        shard->flights = hashtab_init_backend(init.backend, SHARDED_BUFFER_SIZE, init.hash, init.cmp, NULL);
+        hashtab_set_owns_nodes(shard->flights, 0);
+        shard->flight_pool = mempool_init(sharded->flight_page_offset + init.data_size, SHARDED_BUFFER_SIZE);
+        shard->coalesced = 0;
+
+        atomic_init(&shard->dropped, 0);
+        shard->buffers = aligned_alloc(SHARDED_CACHE_LINE, sizeof(sharded_buffer_t) * sharded->nbuffers);
+        if (!shard->buffers) {
+            ERROR("Memory exhausted\n");
+        }
+        for (size_t j = 0; j < sharded->nbuffers; ++j) {
+            atomic_init(&shard->buffers[j].tail, 0);
+            shard->buffers[j].head = 0;
+        }
+    }
+
+    return sharded;
+}
+
+//============================================================================================================
+
+sharded_t lfu_sharded_init(cache_init_t init, size_t nshards) {
+    return sharded_init(init, nshards, &sharded_lfu_policy);
+}
+
+//============================================================================================================
+
+sharded_t lfuda_sharded_init(cache_init_t init, size_t nshards) {
+    return sharded_init(init, nshards, &sharded_lfuda_policy);
+}
+
+//============================================================================================================
+
+void sharded_free(sharded_t cache_) {
+    struct sharded_s *sharded = (struct sharded_s *)cache_;
+
+    assert(sharded);
+
+    for (size_t i = 0; i < sharded->nshards; ++i) {
+        sharded_shard_t *shard = &sharded->shards[i];
+
+        pthread_rwlock_destroy(&shard->lock);
+        sharded->policy->free(shard->cache);
+
+        pthread_mutex_destroy(&shard->flight_lock);
+        pthread_cond_destroy(&shard->flight_done);
+        hashtab_free(shard->flights);
+        mempool_free(shard->flight_pool);
+        free(shard->buffers);
+    }
+
+    free(sharded->shards);
+    free(sharded);
+}
+
+//============================================================================================================
+
+// The hash is mixed before it selects a shard, because the hash table of the shard takes it modulo its own size, and
+// all keys of a shard would fall into the same buckets otherwise
+static inline sharded_shard_t *sharded_shard_of(struct sharded_s *sharded, void **index) {
+    unsigned long hash = sharded->hash(sharded->key_size ? *index : (void *)index);
+    uint64_t mixed = ((uint64_t)hash * UINT64_C(0x9E3779B97F4A7C15)) >> 32;
+
+    return &sharded->shards[mixed % sharded->nshards];
+}
+
+//============================================================================================================
+
+// Buffer of the calling thread, threads get numbers in turn when they first use a cache. There are at least as many
+// buffers as CPUs, so the threads that share a buffer are rarely running at the same time
+static inline sharded_buffer_t *sharded_buffer_of(struct sharded_s *sharded, sharded_shard_t *shard) {
+    static atomic_size_t next = 0;
+    static _Thread_local size_t thread = SIZE_MAX;
+
+    if (thread == SIZE_MAX) {
+        thread = atomic_fetch_add_explicit(&next, 1, memory_order_relaxed);
+    }
+
+    return &shard->buffers[thread & (sharded->nbuffers - 1)];
+}
+
+//============================================================================================================
+
+// Put the promotion of node into the buffer of the calling thread, the read lock of the shard must be held. Returns the
+// number of promotions in the buffer, or SHARDED_BUFFER_SIZE when it is full and the promotion is dropped
+static size_t sharded_buffer_push(struct sharded_s *sharded, sharded_shard_t *shard, local_node_t node) {
+    sharded_buffer_t *buffer = sharded_buffer_of(sharded, shard);
+    size_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+
+    // Another thread of the same buffer takes the slot when the exchange fails, then the promotion is dropped as well
+    if (tail - buffer->head >= SHARDED_BUFFER_SIZE ||
+        !atomic_compare_exchange_strong_explicit(&buffer->tail, &tail, tail + 1, memory_order_relaxed,
+                                                 memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&shard->dropped, 1, memory_order_relaxed);
+        return SHARDED_BUFFER_SIZE;
+    }
+
+    buffer->nodes[tail % SHARDED_BUFFER_SIZE] = node;
+
+    return tail + 1 - buffer->head;
+}
+
+//============================================================================================================
+
+// Apply the buffered promotions, the write lock of the shard must be held. Entries are only evicted under the write
+// lock after the buffers have been drained, so the buffered nodes are still in the cache
+static void sharded_drain(struct sharded_s *sharded, sharded_shard_t *shard) {
+    base_cache_t *cache = (base_cache_t *)shard->cache;
+
+    for (size_t i = 0; i < sharded->nbuffers; ++i) {
+        sharded_buffer_t *buffer = &shard->buffers[i];
+        size_t tail = atomic_load_explicit(&buffer->tail, memory_order_relaxed);
+
+        for (; buffer->head != tail; buffer->head++) {
+            local_node_t node = buffer->nodes[buffer->head % SHARDED_BUFFER_SIZE];
+            sharded->policy->get(cache, local_node_get_data(node).index, node);
+        }
+    }
+}
+
+//============================================================================================================
+
+// Copy the page of an entry found under the read lock and buffer its promotion, the lock is released
+static void sharded_get_found_impl(struct sharded_s *sharded, sharded_shard_t *shard, local_node_t found, void *page) {
+    if (sharded->data_size) {
+        memcpy(page, local_node_get_data(found).cached, sharded->data_size);
+    }
+
+    size_t pending = sharded_buffer_push(sharded, shard, found);
+    pthread_rwlock_unlock(&shard->lock);
+
+    if (pending >= SHARDED_DRAIN_AT && !pthread_rwlock_trywrlock(&shard->lock)) {
+        sharded_drain(sharded, shard);
+        pthread_rwlock_unlock(&shard->lock);
+    }
+}
+
+//============================================================================================================
+
+// Hits only read the cache. The hash table of the shard does not resize, so lookups do not write to it (a resize in
+// progress would make them move buckets, see hashtab_lookup). Returns whether the index has been found
+static int sharded_try_hit(struct sharded_s *sharded, sharded_shard_t *shard, void *index, void *page) {
+    pthread_rwlock_rdlock(&shard->lock);
+
+    local_node_t found = base_cache_lookup((base_cache_t *)shard->cache, &index);
+    if (found) {
+        sharded_get_found_impl(sharded, shard, found, page);
+        return 1;
+    }
+
+    pthread_rwlock_unlock(&shard->lock);
+    return 0;
+}
+
+//============================================================================================================
+
+static inline unsigned char *sharded_flight_page(struct sharded_s *sharded, sharded_flight_t *flight) {
+    return (unsigned char *)flight + sharded->flight_page_offset;
+}
+
+//============================================================================================================
+
+// Wait for the load of index, if there is one in flight, and copy its page. Otherwise start a load, which the calling
+// thread must finish. The flight lock must be held. Returns the started load or NULL if the page has been copied
+static sharded_flight_t *sharded_flight_join(struct sharded_s *sharded, sharded_shard_t *shard, void *index,
+                                             void *page) {
+    void *found = hashtab_lookup(shard->flights, (sharded->key_size ? index : (void *)&index));
+
+    if (found) {
+        size_t offset = (sharded->key_size ? offsetof(sharded_flight_t, key) : offsetof(sharded_flight_t, index));
+        sharded_flight_t *flight = (sharded_flight_t *)((char *)found - offset);
+
+        shard->coalesced++;
+        flight->waiters++;
+        while (!flight->done) {
+            pthread_cond_wait(&shard->flight_done, &shard->flight_lock);
+        }
+
+        if (sharded->data_size) {
+            memcpy(page, sharded_flight_page(sharded, flight), sharded->data_size);
+        }
+
+        // The last thread to leave the finished load frees it
+        if (!--flight->waiters) {
+            mempool_release(shard->flight_pool, flight);
+        }
+
+        return NULL;
+    }
+
+    sharded_flight_t *flight = mempool_alloc(shard->flight_pool);
+    flight->waiters = 0;
+    flight->done = 0;
+
+    if (sharded->key_size) {
+        memcpy(flight->key, index, sharded->key_size);
+        flight->hash_link.link.data = flight->key;
+    } else {
+        flight->index = index;
+        flight->hash_link.link.data = &flight->index;
+    }
+
+    hashtab_insert_node(&shard->flights, &flight->hash_link.link);
+
+    return flight;
+}
+
+//============================================================================================================
+
+// Publish the page of a load to the threads that wait for it
+static void sharded_flight_finish(struct sharded_s *sharded, sharded_shard_t *shard, sharded_flight_t *flight,
+                                  void *page) {
+    if (sharded->data_size) {
+        memcpy(sharded_flight_page(sharded, flight), page, sharded->data_size);
+    }
+
+    pthread_mutex_lock(&shard->flight_lock);
+
+    hashtab_remove_node(shard->flights, flight->hash_link.link.data);
+    flight->done = 1;
+
+    if (flight->waiters) {
+        pthread_cond_broadcast(&shard->flight_done);
+    } else {
+        mempool_release(shard->flight_pool, flight);
+    }
+
+    pthread_mutex_unlock(&shard->flight_lock);
+}
+
+//============================================================================================================
+
+void *sharded_get(sharded_t cache_, void *index, void *page) {
+    struct sharded_s *sharded = (struct sharded_s *)cache_;
+
+    assert(sharded);
+    assert(index);
+    assert(page || !sharded->data_size);
+
+    sharded_shard_t *shard = sharded_shard_of(sharded, &index);
+
+    // 1. Hit under the read lock
+    if (sharded_try_hit(sharded, shard, index, page)) {
+        return page;
+    }
+
+    // 2. Misses of the same index are coalesced, only the first one loads the page and the others wait for it
+    pthread_mutex_lock(&shard->flight_lock);
+    sharded_flight_t *flight = sharded_flight_join(sharded, shard, index, page);
+    pthread_mutex_unlock(&shard->flight_lock);
+
+    if (!flight) {
+        return page;
+    }
+
+    // 3. Another load of the index may have finished after the first lookup, its entry is inserted before the load is
+    // removed from the flights
+    if (!sharded_try_hit(sharded, shard, index, page)) {
+        // Pages are loaded outside of the shard lock, so that slow loaders do not stop the other keys of the shard
+        void *loaded = (sharded->get ? sharded->get(index) : NULL);
+
+        pthread_rwlock_wrlock(&shard->lock);
+
+        sharded_drain(sharded, shard);
+
+        base_cache_t *cache = (base_cache_t *)shard->cache;
+        sharded_loaded_page = loaded;
+        void *cached = sharded->policy->get(cache, index, base_cache_lookup(cache, &index));
+        if (sharded->data_size) {
+            memcpy(page, cached, sharded->data_size);
+        }
+
+        pthread_rwlock_unlock(&shard->lock);
+    }
+
+    sharded_flight_finish(sharded, shard, flight, page);
+
+    return page;
+}
+
+//============================================================================================================
+
+size_t sharded_get_hits(sharded_t cache_) {
+    struct sharded_s *sharded = (struct sharded_s *)cache_;
+
+    assert(sharded);
+
+    // Dropped promotions are hits as well
+    size_t hits = 0;
+    for (size_t i = 0; i < sharded->nshards; ++i) {
+        sharded_shard_t *shard = &sharded->shards[i];
+
+        pthread_rwlock_wrlock(&shard->lock);
+        sharded_drain(sharded, shard);
+        hits += ((base_cache_t *)shard->cache)->hits + atomic_load_explicit(&shard->dropped, memory_order_relaxed);
+        pthread_rwlock_unlock(&shard->lock);
+    }
+
+    return hits;
+}
+
+//============================================================================================================
+
+size_t sharded_get_dropped(sharded_t cache_) {
+    struct sharded_s *sharded = (struct sharded_s *)cache_;
+
+    assert(sharded);
+
+    size_t dropped = 0;
+    for (size_t i = 0; i < sharded->nshards; ++i) {
+        dropped += atomic_load_explicit(&sharded->shards[i].dropped, memory_order_relaxed);
+    }
+
+    return dropped;
+}
+
+//============================================================================================================
+
+size_t sharded_get_coalesced(sharded_t cache_) {
+    struct sharded_s *sharded = (struct sharded_s *)cache_;
+
+    assert(sharded);
+
+    size_t coalesced = 0;
+    for (size_t i = 0; i < sharded->nshards; ++i) {
+        sharded_shard_t *shard = &sharded->shards[i];
+
+        pthread_mutex_lock(&shard->flight_lock);
+        coalesced += shard->coalesced;
+        pthread_mutex_unlock(&shard->flight_lock);
+    }
+
+    return coalesced;
+}
+
+//============================================================================================================
+
+size_t sharded_get_age(sharded_t cache_) {
+    struct sharded_s *sharded = (struct sharded_s *)cache_;
+
+    assert(sharded);
+
+    if (!sharded->policy->get_age) {
+        return 0;
+    }
+
+    size_t age = 0;
+    for (size_t i = 0; i < sharded->nshards; ++i) {
+        sharded_shard_t *shard = &sharded->shards[i];
+
+        // Promotions do not change the age, so the buffers are not drained
+        pthread_rwlock_rdlock(&shard->lock);
+        size_t shard_age = sharded->policy->get_age(shard->cache);
+        pthread_rwlock_unlock(&shard->lock);
+
+        age = (shard_age > age ? shard_age : age);
+    }
+
+    return age;
+}
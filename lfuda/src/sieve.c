@@ -0,0 +1,246 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "sieve.h"
+#include "basecache.h"
+#include "clist.h"
+
+#include "memutil.h"
+#include <assert.h>
+#include <string.h>
+
+//============================================================================================================
+// Refer to "SIEVE is Simpler than LRU: an Efficient Turn-Key Eviction Algorithm for Web Caches" by Zhang et al. for
+// more information
+//
+// Entries are base cache slots in a single FIFO queue, which is the local list of a frequency node that is not linked
+// into the frequency list. New entries go to the head and are never moved. Frequency of the entry is its visited bit: a
+// hit sets it, while the hand walks from the tail to the head, clears the bits and evicts the first entry without one
+struct sieve_s {
+    base_cache_t base;
+
+    freq_node_t queue;
+    // Next entry to look at, NULL when the hand starts again from the tail
+    local_node_t hand;
+};
+
+//============================================================================================================
+
+sieve_t sieve_init(cache_init_t init) {
+    assert(!init.admission);
+    assert(!init.fill);
+
+    struct sieve_s *sieve = calloc_checked(1, sizeof(struct sieve_s));
+
+    base_cache_init(&sieve->base, init);
+
+    // The queue is never freed, so the pool is reserved for it on top of the frequency nodes of the entries
+    mempool_reserve(sieve->base.freq_pool, init.size + 1 + 1);
+    sieve->queue = freq_node_init(sieve->base.freq_pool, 0);
+    sieve->hand = NULL;
+
+    return sieve;
+}
+
+//============================================================================================================
+
+void sieve_free(sieve_t cache_) {
+    struct sieve_s *sieve = (struct sieve_s *)cache_;
+
+    assert(sieve);
+
+    base_cache_free(&sieve->base);
+
+    free(sieve);
+}
+
+//============================================================================================================
+
+// Move the hand to the first entry that has not been visited, clearing the bits of the ones it passes, and remove that
+// entry from the cache. Returns the removed node, whose slot is either reused or released
+static local_node_t sieve_evict(struct sieve_s *sieve) {
+    base_cache_t *basecache = &sieve->base;
+    local_list_t queue = freq_node_get_local(sieve->queue);
+
+    local_node_t toevict = (sieve->hand ? sieve->hand : dl_list_get_last(queue));
+    assert(toevict);
+
+    // Every entry is passed at most once before the hand gets back to one with a cleared bit
+    while (local_node_get_slot(toevict)->local.frequency) {
+        local_node_get_slot(toevict)->local.frequency = 0;
+        toevict = dl_node_get_prev(toevict);
+        toevict = (toevict ? toevict : dl_list_get_last(queue));
+    }
+
+    sieve->hand = dl_node_get_prev(toevict);
+
+    hashtab_remove_node(basecache->table, base_cache_slot_key(basecache, local_node_get_slot(toevict)));
+    dl_list_remove(queue, toevict);
+
+    return toevict;
+}
+
+//============================================================================================================
+
+static void *sieve_get_case_found_impl(base_cache_t *basecache, local_node_t found) {
+    basecache->hits += 1;
+
+    // The slot is only written when the bit changes, so hits of hot entries do not dirty their cache lines
+    cache_slot_t *slot = local_node_get_slot(found);
+    if (!slot->local.frequency) {
+        slot->local.frequency = 1;
+    }
+
+    return slot->local.cached;
+}
+
+//============================================================================================================
+
+static void *sieve_get_case_not_found_impl(struct sieve_s *sieve, void *index) {
+    base_cache_t *basecache = &sieve->base;
+
+    void *page = base_cache_load(basecache, index);
+    char *curr_data_ptr = NULL;
+    local_node_t toinsert = NULL;
+
+    // The slot and data of the evicted entry are reused for the new one
+    if (basecache->curr_top >= basecache->size) {
+        toinsert = sieve_evict(sieve);
+        curr_data_ptr = base_cache_replace_page(basecache, local_node_get_data(toinsert).cached);
+    } else {
+        toinsert = base_cache_new_slot(basecache, &curr_data_ptr);
+    }
+
+    local_node_data_t local_data = {0};
+    local_data.index = index;
+    local_data.root_node = sieve->queue;
+    if (basecache->data_size) {
+        local_data.cached = curr_data_ptr;
+    }
+
+    base_cache_insert(basecache, sieve->queue, toinsert, local_data);
+
+    if (basecache->data_size) {
+        memcpy(curr_data_ptr, page, basecache->data_size);
+    }
+
+    return base_cache_miss_page(basecache, page, curr_data_ptr);
+}
+
+//============================================================================================================
+
+static void *sieve_insert_sized(struct sieve_s *sieve, void *index, size_t *length) {
+    base_cache_t *basecache = &sieve->base;
+
+    void *page = basecache->sized_get(index, length);
+
+    // The page would not fit even into the empty cache
+    if (!base_cache_fits(basecache, *length)) {
+        return page;
+    }
+
+    // Evict until there is room both for a slot and for the page in the slab
+    while (base_cache_is_full(basecache, *length)) {
+        base_cache_release_sized(basecache, sieve_evict(sieve));
+    }
+
+    local_node_data_t local_data = {0};
+    local_data.index = index;
+    local_data.root_node = sieve->queue;
+    base_cache_store_sized(basecache, &local_data, page, *length);
+
+    base_cache_insert(basecache, sieve->queue, base_cache_node_init(basecache), local_data);
+    basecache->curr_top += 1;
+
+    return page;
+}
+
+//============================================================================================================
+
+static void *sieve_get_impl(base_cache_t *basecache, void *index, local_node_t found) {
+    // In this case strict-aliasing does not apply, because base_cache_t is the first member of sieve_s struct
+    struct sieve_s *sieve = (struct sieve_s *)basecache;
+
+    if (found) {
+        return sieve_get_case_found_impl(basecache, found);
+    }
+
+    if (basecache->slab) {
+        size_t length = 0;
+        return sieve_insert_sized(sieve, index, &length);
+    }
+
+    return sieve_get_case_not_found_impl(sieve, index);
+}
+
+//============================================================================================================
+
+void *sieve_get(sieve_t cache_, void *index) {
+    struct sieve_s *sieve = (struct sieve_s *)cache_;
+
+    assert(sieve);
+    assert(index);
+
+    return sieve_get_impl(&sieve->base, index, base_cache_lookup(&sieve->base, &index));
+}
+
+//============================================================================================================
+
+void *sieve_get_sized(sieve_t cache_, void *index, size_t *length) {
+    struct sieve_s *sieve = (struct sieve_s *)cache_;
+
+    assert(sieve);
+    assert(index);
+    assert(length);
+
+    local_node_t found = base_cache_lookup(&sieve->base, &index);
+
+    if (!sieve->base.slab) {
+        *length = sieve->base.data_size;
+        return sieve_get_impl(&sieve->base, index, found);
+    }
+
+    if (found) {
+        *length = local_node_get_data(found).size;
+        return sieve_get_case_found_impl(&sieve->base, found);
+    }
+
+    return sieve_insert_sized(sieve, index, length);
+}
+
+//============================================================================================================
+
+void sieve_get_many(sieve_t cache_, void **indices, void **results, size_t count) {
+    struct sieve_s *sieve = (struct sieve_s *)cache_;
+
+    assert(sieve);
+
+    base_cache_get_many(&sieve->base, indices, results, count, sieve_get_impl);
+}
+
+//============================================================================================================
+
+size_t sieve_get_hits(sieve_t cache_) {
+    // In this case strict-aliasing does not apply, because base_cache_t is the first member of sieve_s struct
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->hits;
+}
+
+//============================================================================================================
+
+size_t sieve_get_used(sieve_t cache_) {
+    base_cache_t *cache = (base_cache_t *)cache_;
+
+    assert(cache);
+
+    return cache->used;
+}
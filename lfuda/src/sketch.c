@@ -0,0 +1,142 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "sketch.h"
+#include "hashmix.h"
+
+#include "memutil.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+//============================================================================================================
+
+// A block is a cache line of 8 words with 16 counters each. Every key has SKETCH_DEPTH counters in different words of
+// its block, so that collisions in one of them do not affect the others
+#define SKETCH_BLOCK_WORDS 8
+#define SKETCH_DEPTH       4
+#define SKETCH_LINE        64
+
+// Counters are halved after this many increments per entry of the capacity
+#define SKETCH_SAMPLE_FACTOR 10
+
+typedef struct {
+    uint64_t words[SKETCH_BLOCK_WORDS];
+} sketch_block_t;
+
+struct sketch_s {
+    sketch_block_t *blocks;
+    // Number of blocks is a power of two
+    size_t mask;
+
+    size_t additions;
+    size_t sample_size;
+
+    // Memory returned by calloc, blocks are aligned to the cache line inside of it
+    void *memory;
+};
+
+//============================================================================================================
+
+sketch_t *sketch_init(size_t capacity) {
+    struct sketch_s *sketch = calloc_checked(1, sizeof(struct sketch_s));
+
+    // About 16 counters for every entry of the capacity, as 128 counters fit into a block
+    size_t count = 1;
+    while (count * SKETCH_BLOCK_WORDS < capacity) {
+        count <<= 1;
+    }
+
+    sketch->memory = calloc_checked(count + 1, sizeof(sketch_block_t));
+    sketch->blocks = (sketch_block_t *)(((uintptr_t)sketch->memory + SKETCH_LINE - 1) & ~(uintptr_t)(SKETCH_LINE - 1));
+    sketch->mask = count - 1;
+
+    sketch->additions = 0;
+    sketch->sample_size = SKETCH_SAMPLE_FACTOR * (capacity ? capacity : 1);
+
+    return sketch;
+}
+
+//============================================================================================================
+
+void sketch_free(sketch_t *sketch) {
+    assert(sketch);
+
+    free(sketch->memory);
+    free(sketch);
+}
+
+//============================================================================================================
+
+// Halve all counters. Each counter is shifted right within its nibble, so the top bit of the lower one is dropped
+
+static void sketch_reset(struct sketch_s *sketch) {
+    for (size_t i = 0; i <= sketch->mask; i++) {
+        for (size_t j = 0; j < SKETCH_BLOCK_WORDS; j++) {
+            sketch->blocks[i].words[j] = (sketch->blocks[i].words[j] >> 1) & 0x7777777777777777ULL;
+        }
+    }
+
+    sketch->additions /= 2;
+}
+
+//============================================================================================================
+
+// Low bits of the mixed hash select the block and the high bits select a word and a counter for every row. The word
+// of row i is one of the pair 2i, 2i + 1, so that rows never share a word
+
+static inline unsigned sketch_word(uint64_t h, unsigned row) {
+    return row * 2 + (unsigned)((h >> (32 + row * 8)) & 1);
+}
+
+static inline unsigned sketch_shift(uint64_t h, unsigned row) {
+    return (unsigned)((h >> (32 + row * 8 + 1)) & 15) * 4;
+}
+
+//============================================================================================================
+
+void sketch_increment(sketch_t *sketch, unsigned long hash) {
+    assert(sketch);
+
+    uint64_t h = hashmix_murmur(hash);
+    sketch_block_t *block = &sketch->blocks[h & sketch->mask];
+
+    int added = 0;
+    for (unsigned row = 0; row < SKETCH_DEPTH; row++) {
+        uint64_t *word = &block->words[sketch_word(h, row)];
+        unsigned shift = sketch_shift(h, row);
+
+        if (((*word >> shift) & 15) != 15) {
+            *word += (uint64_t)1 << shift;
+            added = 1;
+        }
+    }
+
+    if (added && ++sketch->additions >= sketch->sample_size) {
+        sketch_reset(sketch);
+    }
+}
+
+//============================================================================================================
+
+unsigned sketch_estimate(sketch_t *sketch, unsigned long hash) {
+    assert(sketch);
+
+    uint64_t h = hashmix_murmur(hash);
+    sketch_block_t *block = &sketch->blocks[h & sketch->mask];
+
+    unsigned result = 15;
+    for (unsigned row = 0; row < SKETCH_DEPTH; row++) {
+        unsigned count = (unsigned)((block->words[sketch_word(h, row)] >> sketch_shift(h, row)) & 15);
+        result = (count < result ? count : result);
+    }
+
+    return result;
+}
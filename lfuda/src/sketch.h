@@ -0,0 +1,23 @@
+#ifndef LFUDA_SKETCH_H
+#define LFUDA_SKETCH_H
+
+#include <stddef.h>
+
+// Count-min sketch of 4-bit counters, which estimates how often keys were seen recently. Counters of a key are all in
+// the same 64-byte block, so that every increment and estimate touches a single cache line. After a number of
+// increments proportional to the capacity all counters are halved, so that old popularity fades away
+struct sketch_s;
+typedef struct sketch_s sketch_t;
+
+// Create sketch for a cache of capacity entries
+sketch_t *sketch_init(size_t capacity);
+
+void sketch_free(sketch_t *sketch);
+
+// Count one more occurrence of the key with hash
+void sketch_increment(sketch_t *sketch, unsigned long hash);
+
+// Get estimated number of occurrences of the key with hash, which is at most 15
+unsigned sketch_estimate(sketch_t *sketch, unsigned long hash);
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * ----------------------------------------------------------------------------
+ * "THE BEER-WARE LICENSE" (Revision 42):
+ * <tsimmerman.ss@phystech.edu>, <gerasimenko.dv@phystech.edu>, <alex.rom23@mail.ru> wrote this file.  As long as you
+ * retain this notice you can do whatever you want with this stuff. If we meet some day, and you think this stuff is
+ * worth it, you can buy us a beer in return.
+ * ----------------------------------------------------------------------------
+ */
+
+#include "slab.h"
+#include "mempool.h"
+
+#include "memutil.h"
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+//============================================================================================================
+
+// The smallest class is 2^SLAB_MIN_SHIFT bytes, then there are SLAB_STEPS classes up to every next power of two. All
+// class sizes are multiples of the pool object alignment, so that no bytes are lost to it
+#define SLAB_MIN_SHIFT 6
+#define SLAB_STEPS     4
+#define SLAB_CLASSES   (SLAB_STEPS * (sizeof(size_t) * CHAR_BIT - SLAB_MIN_SHIFT) + 1)
+
+// Classes grow by chunks of about this size, but at least by one object
+#define SLAB_CHUNK_BYTES ((size_t)64 * 1024)
+
+struct slab_s {
+    // Pools are created when the first object of the class is allocated
+    mempool_t *classes[SLAB_CLASSES];
+};
+
+//============================================================================================================
+
+// Index of the smallest class that fits length bytes
+
+static size_t slab_class_of(size_t length) {
+    if (length <= ((size_t)1 << SLAB_MIN_SHIFT)) {
+        return 0;
+    }
+
+    // 2^shift < length <= 2^(shift + 1)
+    size_t shift = SLAB_MIN_SHIFT;
+    while (shift + 1 < sizeof(size_t) * CHAR_BIT && ((size_t)1 << (shift + 1)) < length) {
+        shift++;
+    }
+
+    size_t base = (size_t)1 << shift, step = base / SLAB_STEPS;
+    size_t substep = (length - base + step - 1) / step;
+
+    return (shift - SLAB_MIN_SHIFT) * SLAB_STEPS + substep;
+}
+
+//============================================================================================================
+
+static size_t slab_class_bytes(size_t class) {
+    if (class == 0) {
+        return (size_t)1 << SLAB_MIN_SHIFT;
+    }
+
+    size_t shift = SLAB_MIN_SHIFT + (class - 1) / SLAB_STEPS;
+    size_t substep = (class - 1) % SLAB_STEPS + 1;
+    size_t base = (size_t)1 << shift;
+
+    return base + substep * (base / SLAB_STEPS);
+}
+
+//============================================================================================================
+
+slab_t *slab_init(void) {
+    return calloc_checked(1, sizeof(struct slab_s));
+}
+
+//============================================================================================================
+
+void slab_free(slab_t *slab) {
+    assert(slab);
+
+    for (size_t i = 0; i < SLAB_CLASSES; i++) {
+        if (slab->classes[i]) {
+            mempool_free(slab->classes[i]);
+        }
+    }
+
+    free(slab);
+}
+
+//============================================================================================================
+
+size_t slab_class_size(size_t length) {
+    return slab_class_bytes(slab_class_of(length));
+}
+
+//============================================================================================================
+
+void *slab_alloc(slab_t *slab, size_t length) {
+    assert(slab);
+
+    size_t class = slab_class_of(length);
+    assert(class < SLAB_CLASSES);
+
+    if (!slab->classes[class]) {
+        size_t bytes = slab_class_bytes(class);
+        size_t count = (bytes < SLAB_CHUNK_BYTES ? SLAB_CHUNK_BYTES / bytes : 1);
+        slab->classes[class] = mempool_init(bytes, count);
+    }
+
+    return mempool_alloc(slab->classes[class]);
+}
+
+//============================================================================================================
+
+void slab_release(slab_t *slab, void *obj, size_t length) {
+    assert(slab);
+    assert(obj);
+
+    size_t class = slab_class_of(length);
+    assert(slab->classes[class]);
+
+    mempool_release(slab->classes[class], obj);
+}
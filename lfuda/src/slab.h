@@ -0,0 +1,26 @@
+#ifndef LFUDA_SLAB_H
+#define LFUDA_SLAB_H
+
+#include <stddef.h>
+
+// Storage for values of variable length. Lengths are rounded up to size classes, four for every power of two, and
+// every class is a separate pool with its own free list, so that freed objects are reused by values of the same class
+// in O(1) without fragmenting the heap
+struct slab_s;
+typedef struct slab_s slab_t;
+
+slab_t *slab_init(void);
+
+// Free all objects together with the slab
+void slab_free(slab_t *slab);
+
+// Number of bytes taken by an object of length bytes
+size_t slab_class_size(size_t length);
+
+// Allocate an object for length bytes
+void *slab_alloc(slab_t *slab, size_t length);
+
+// Return object allocated for length bytes back to its class
+void slab_release(slab_t *slab, void *obj, size_t length);
+
+#endif
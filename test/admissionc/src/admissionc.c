@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lfu.h"
+#include "lfuda.h"
+
+// Hot keys are requested in a loop, but between two requests of the same hot key there are more one-hit keys of a scan
+// than the cache can hold. Without admission every hot key is evicted by the scan before it is requested again. With
+// admission the hot keys are seen more often than the scan keys, so they replace the scan keys and stay in the cache
+
+typedef struct {
+    int value;
+} index_t;
+
+static unsigned long index_hash(index_t *a) {
+    return (unsigned long)(a->value);
+}
+
+static int index_cmp(index_t *a, index_t *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+#define CACHE_SIZE 100
+#define HOT_KEYS   50
+#define SCAN_STEP  4
+#define ROUNDS     200
+#define BATCH      16
+
+// Every key has its own page, so that pages returned for a batch stay valid until it is checked
+static int pages[HOT_KEYS * (SCAN_STEP + 1) * ROUNDS];
+
+static void *get_page(index_t *index) {
+    pages[index->value] = index->value;
+    return &pages[index->value];
+}
+
+// Both policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get)(void *cache, void *index);
+    void (*get_many)(void *cache, void **indices, void **results, size_t count);
+    size_t (*get_hits)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get, lfu_get_many, lfu_get_hits},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get, lfuda_get_many, lfuda_get_hits},
+};
+
+// Runs the trace through the cache and returns the number of hits, or 0 if a wrong page is returned
+static size_t run(const policy_t *policy, int admission, int batched) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = CACHE_SIZE,
+        .data_size = sizeof(int),
+        .key_size = sizeof(index_t),
+        .admission = admission,
+    };
+    void *cache = policy->init(init);
+
+    index_t indices[BATCH];
+    void *indexptrs[BATCH], *results[BATCH];
+    size_t count = 0;
+    int next_scan = HOT_KEYS;
+    int wrong = 0;
+
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (int hot = 0; hot < HOT_KEYS; ++hot) {
+            for (int step = 0; step <= SCAN_STEP; ++step) {
+                indices[count].value = (step == 0 ? hot : next_scan++);
+                indexptrs[count] = &indices[count];
+                count++;
+
+                if (count < (batched ? BATCH : 1)) {
+                    continue;
+                }
+
+                if (batched) {
+                    policy->get_many(cache, indexptrs, results, count);
+                } else {
+                    results[0] = policy->get(cache, indexptrs[0]);
+                }
+
+                for (size_t i = 0; i < count; ++i) {
+                    wrong |= (*(int *)results[i] != indices[i].value);
+                }
+                count = 0;
+            }
+        }
+    }
+
+    size_t hits = policy->get_hits(cache);
+    policy->free(cache);
+
+    if (wrong) {
+        fprintf(stderr, "%s: wrong page returned\n", policy->name);
+        return 0;
+    }
+
+    return hits;
+}
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        const policy_t *policy = &policies[i];
+
+        size_t plain = run(policy, 0, 0);
+        size_t admitted = run(policy, 1, 0);
+        size_t batched = run(policy, 1, 1);
+
+        printf("%s: hits %lu without admission, %lu with admission\n", policy->name, plain, admitted);
+
+        // Most of the hot requests after the first round must hit
+        if (admitted < (size_t)HOT_KEYS * ROUNDS / 2 || admitted <= plain) {
+            fprintf(stderr, "%s: admission does not protect the hot keys\n", policy->name);
+            failed = 1;
+        }
+
+        if (batched != admitted) {
+            fprintf(stderr, "%s: batched gets hit %lu times instead of %lu\n", policy->name, batched, admitted);
+            failed = 1;
+        }
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
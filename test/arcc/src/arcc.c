@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+#include "arc.h"
+
+typedef struct {
+    int value;
+} index_t;
+
+// Indices are owned by the cache, so hash and cmp receive pointers to them
+unsigned long index_hash(index_t *a) {
+    return (unsigned long)(a->value);
+}
+
+int index_cmp(index_t *a, index_t *b) {
+    return (a->value) - (b->value);
+}
+
+void *get_page(index_t *index) {
+    UNUSED_PARAMETER(index);
+    static int a = 5;
+    return &a;
+}
+
+int main() {
+    size_t m = 0, n = 0;
+
+    int res = scanf("%lu %lu", &m, &n);
+    if (res != 2) {
+        ERROR("Invalid input\n");
+    }
+
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = m,
+        .data_size = sizeof(int),
+        .key_size = sizeof(index_t),
+    };
+
+    arc_t arc = arc_init(init);
+
+    for (size_t i = 0; i < n; ++i) {
+        index_t index = {0};
+        if (scanf("%d", &index.value) != 1) {
+            ERROR("Invalid input\n");
+        }
+        arc_get(arc, &index);
+    }
+
+    printf("%lu\n", arc_get_hits(arc));
+
+    arc_free(arc);
+}
@@ -0,0 +1,134 @@
+#!/usr/bin/python
+
+import random, sys, getopt, os
+from collections import OrderedDict
+
+usage_string = "testgen.py -n <num> -o output"
+
+
+MAX_REQUEST_VALUE = 200
+MAX_CACHE_SIZE = 100
+MAX_REQUESTS_NUMBER = 10000
+
+def GenerateTest(test_number, cache_size, requests_number):
+    test_str = []
+    test_str.append(str(cache_size))
+    test_str.append(str(requests_number))
+
+    # Mix of a frequently used set and scans, so that both recency and frequency matter
+    hot = random.sample(range(MAX_REQUEST_VALUE + 1), random.randint(1, MAX_REQUEST_VALUE // 2))
+    for request in range(requests_number):
+        if random.random() < 0.5:
+            test_str.append(str(random.choice(hot)))
+        else:
+            test_str.append(str(random.randint(0, MAX_REQUEST_VALUE)))
+    return test_str
+
+def GenerateRandomTest(test_number):
+    cache_size = random.randint(1, MAX_CACHE_SIZE)
+    requests_number = random.randint(1, MAX_REQUESTS_NUMBER)
+    test_str = GenerateTest(test_number, cache_size, requests_number)
+    return test_str
+
+# Lists keep the most recently used entry last
+class ARC:
+    def __init__(self, size):
+        self.size = size
+        self.target = 0
+        self.t1 = OrderedDict()
+        self.t2 = OrderedDict()
+        self.b1 = OrderedDict()
+        self.b2 = OrderedDict()
+        self.hits = 0
+
+    def replace(self, in_b2):
+        if self.t1 and ((in_b2 and len(self.t1) == self.target) or len(self.t1) > self.target):
+            key, _ = self.t1.popitem(last=False)
+            self.b1[key] = True
+        else:
+            key, _ = self.t2.popitem(last=False)
+            self.b2[key] = True
+
+    def get(self, key):
+        c = self.size
+        if key in self.t1 or key in self.t2:
+            self.hits += 1
+            self.t1.pop(key, None)
+            self.t2.pop(key, None)
+            self.t2[key] = True
+        elif key in self.b1:
+            delta = len(self.b2) // len(self.b1) if len(self.b2) > len(self.b1) else 1
+            self.target = min(self.target + delta, c)
+            self.replace(False)
+            del self.b1[key]
+            self.t2[key] = True
+        elif key in self.b2:
+            delta = len(self.b1) // len(self.b2) if len(self.b1) > len(self.b2) else 1
+            self.target = max(self.target - delta, 0)
+            self.replace(True)
+            del self.b2[key]
+            self.t2[key] = True
+        else:
+            total = len(self.t1) + len(self.t2) + len(self.b1) + len(self.b2)
+            if len(self.t1) + len(self.b1) == c:
+                if len(self.t1) < c:
+                    self.b1.popitem(last=False)
+                    self.replace(False)
+                else:
+                    self.t1.popitem(last=False)
+            elif total >= c:
+                if total == 2 * c:
+                    self.b2.popitem(last=False)
+                if len(self.t1) + len(self.t2) == c:
+                    self.replace(False)
+            self.t1[key] = True
+
+def GenerateAnswer(test):
+    cache_size = int(test[0])
+    test_list = [int(request) for request in test[2:]]
+
+    arc = ARC(cache_size)
+    for index in test_list:
+        arc.get(index)
+    return arc.hits
+
+
+class CmdArgs:
+    number_of_tests = 0
+    output_path = "./resources"
+
+    def __init__(self):
+        pass
+
+def Generate_N_Random_Tests (cmd):
+    for test_number in range(cmd.number_of_tests):
+        test_str = GenerateRandomTest(test_number)
+        with open (os.path.join(cmd.output_path, "test{}.dat".format(test_number)), 'w+') as test_file:
+            test_file.write("{}".format(" ".join(test_str)))
+        answ = GenerateAnswer(test_str)
+        with open (os.path.join(cmd.output_path, "answ{}.dat".format(test_number)), "w+") as answer_file:
+            answer_file.write("{}\n".format(answ))
+
+
+
+def main (argv):
+    cmd = CmdArgs()
+    try:
+        opts, args = getopt.getopt(argv, "hn:o:")
+    except getopt.GetoptError:
+        print(usage_string)
+        sys.exit()
+    for opt, arg in opts:
+        if opt == "-h":
+            print(usage_string)
+            sys.exit()
+        if opt in ("-o", "--output"):
+            cmd.output_path = str(arg)
+        if opt in ("-n", "--number"):
+            cmd.number_of_tests = int(arg)
+
+    Generate_N_Random_Tests (cmd)
+
+
+
+main(sys.argv[1:])
@@ -0,0 +1,183 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+
+#include "lfu.h"
+#include "lfuda.h"
+
+// Asynchronous gets are checked against an event loop, which completes every load a fixed number of requests after it
+// has been started. Every get must get exactly one callback with the right page. When loads are completed at once, the
+// hits must be the same as with synchronous gets, and with delayed loads the misses of the same index share one load
+
+typedef struct {
+    int value;
+} index_t;
+
+typedef struct {
+    int value[4];
+} page_t;
+
+static unsigned long index_hash(index_t *a) {
+    return (unsigned long)(a->value);
+}
+
+static int index_cmp(index_t *a, index_t *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+static void *get_page(index_t *index) {
+    static page_t page;
+    page.value[0] = index->value;
+    return &page;
+}
+
+static unsigned long long rand_state = 11;
+
+// Skewed keys, so that there are both frequently and rarely used entries
+static int next_index(void) {
+    rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = rand_state >> 33;
+    return (int)(r % (1 + r % 1024));
+}
+
+#define CACHE_SIZE 128
+#define REQUESTS   100000
+
+//============================================================================================================
+
+// Loads in flight of the event loop, in the order they have been started
+typedef struct {
+    int value;
+    size_t started;
+} load_t;
+
+static load_t loads[REQUESTS];
+static size_t loads_first = 0, loads_last = 0;
+static size_t request = 0;
+static int loads_twice = 0;
+
+// Misses of an index that is being loaded must wait for that load
+static void start_load(index_t *index) {
+    for (size_t i = loads_first; i < loads_last; ++i) {
+        loads_twice |= (loads[i].value == index->value);
+    }
+
+    load_t load = {index->value, request};
+    loads[loads_last++] = load;
+}
+
+// Gets wait for their callbacks, which check the page
+typedef struct {
+    int value;
+    int calls;
+    int wrong;
+} get_t;
+
+static get_t gets[REQUESTS];
+
+static void get_done(get_t *get, page_t *page) {
+    get->calls += 1;
+    get->wrong |= (page->value[0] != get->value);
+}
+
+//============================================================================================================
+
+// All policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get)(void *cache, void *index);
+    int (*get_async)(void *cache, void *index, cache_callback_t callback, void *ctx);
+    void (*complete_load)(void *cache, void *index, void *page);
+    size_t (*get_hits)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get, lfu_get_async, lfu_complete_load, lfu_get_hits},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get, lfuda_get_async, lfuda_complete_load, lfuda_get_hits},
+};
+
+// Complete the loads that have been started at least delay requests ago
+static void complete_loads(const policy_t *policy, void *cache, size_t delay) {
+    while (loads_first != loads_last && loads[loads_first].started + delay <= request) {
+        index_t index = {loads[loads_first++].value};
+        policy->complete_load(cache, &index, get_page(&index));
+    }
+}
+
+static int test_delay(const policy_t *policy, size_t delay) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = CACHE_SIZE,
+        .data_size = sizeof(page_t),
+        .key_size = sizeof(index_t),
+    };
+    void *sync = policy->init(init);
+
+    init.get = NULL;
+    init.start_load = CACHE_START_LOAD_F(start_load);
+    void *async = policy->init(init);
+
+    memset(gets, 0, sizeof(gets));
+    loads_first = loads_last = 0;
+    loads_twice = 0;
+    rand_state = 11;
+
+    size_t outstanding = 0;
+    for (request = 0; request < REQUESTS; ++request) {
+        index_t index = {next_index()};
+
+        policy->get(sync, &index);
+
+        gets[request].value = index.value;
+        policy->get_async(async, &index, CACHE_CALLBACK_F(get_done), &gets[request]);
+
+        outstanding = (loads_last - loads_first > outstanding ? loads_last - loads_first : outstanding);
+        complete_loads(policy, async, delay);
+    }
+
+    // The rest of the loads are completed at the end
+    complete_loads(policy, async, 0);
+
+    int failed = 0;
+    for (size_t r = 0; r < REQUESTS; ++r) {
+        if (gets[r].calls != 1 || gets[r].wrong) {
+            fprintf(stderr, "%s: get %lu of %d got %d callbacks\n", policy->name, r, gets[r].value, gets[r].calls);
+            failed = 1;
+            break;
+        }
+    }
+
+    // Misses that are waiting for a load do not start another one, and without delay every miss loads its page
+    size_t misses = REQUESTS - policy->get_hits(async);
+    int same = (loads_last == misses && policy->get_hits(sync) == policy->get_hits(async));
+    if (loads_twice || loads_last > misses || (!delay && !same)) {
+        fprintf(stderr, "%s: %lu loads for %lu misses with delay %lu\n", policy->name, loads_last, misses, delay);
+        failed = 1;
+    }
+
+    printf("%s: delay %lu, hits %lu, loads %lu, outstanding %lu\n", policy->name, delay, policy->get_hits(async),
+           loads_last, outstanding);
+
+    policy->free(sync);
+    policy->free(async);
+
+    return failed;
+}
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        failed |= test_delay(&policies[i], 0);
+        failed |= test_delay(&policies[i], 500);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
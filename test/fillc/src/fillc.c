@@ -0,0 +1,168 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "error.h"
+
+#include "lfu.h"
+#include "lfuda.h"
+
+// Caches that fill pages in place are checked against the ones with a loader that returns pages. Without failed fills
+// both must have the same hits, and every get of the filling cache must return the page in the cache. Fills of some
+// indices fail, and then the get must return NULL, and the index must not be inserted, so that every get of it misses
+
+#define PAGE_WORDS 8
+
+typedef struct {
+    uint64_t value[PAGE_WORDS];
+} page_t;
+
+static unsigned long index_hash(uint64_t *a) {
+    return (unsigned long)(*a);
+}
+
+static int index_cmp(uint64_t *a, uint64_t *b) {
+    return (*a != *b);
+}
+
+static void *get_page(uint64_t *index) {
+    static page_t page;
+    for (size_t i = 0; i < PAGE_WORDS; ++i) {
+        page.value[i] = *index;
+    }
+    return &page;
+}
+
+// Indices whose fills fail, when failures are enabled
+#define FAILING(index) ((index) % 7 == 3)
+
+static int fails = 0;
+static size_t fills = 0;
+static size_t failed_fills = 0;
+
+static int fill_page(uint64_t *index, page_t *dst, size_t cap) {
+    if (cap != sizeof(page_t)) {
+        ERROR("Fill got %lu bytes instead of %lu\n", cap, sizeof(page_t));
+    }
+
+    fills += 1;
+    if (fails && FAILING(*index)) {
+        failed_fills += 1;
+        // Fills may write part of the page before they fail
+        memset(dst, 0xff, cap / 2);
+        return -1;
+    }
+
+    for (size_t i = 0; i < PAGE_WORDS; ++i) {
+        dst->value[i] = *index;
+    }
+    return 0;
+}
+
+#define CACHE_SIZE 128
+#define KEYS       2048
+#define REQUESTS   100000
+
+// Skewed keys, so that there are both hits and evictions
+static uint64_t next_index(unsigned long long *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = *state >> 33;
+    return r % (1 + r % KEYS);
+}
+
+//============================================================================================================
+
+// All policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get)(void *cache, void *index);
+    size_t (*get_hits)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get, lfu_get_hits},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get, lfuda_get_hits},
+};
+
+static int test_fill(const policy_t *policy, int with_failures) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = CACHE_SIZE,
+        .data_size = sizeof(page_t),
+        .key_size = sizeof(uint64_t),
+    };
+    void *copying = policy->init(init);
+
+    init.get = NULL;
+    init.fill = CACHE_FILL_F(fill_page);
+    void *filling = policy->init(init);
+
+    fails = with_failures;
+    fills = failed_fills = 0;
+
+    unsigned long long state = 1;
+    size_t failing_gets = 0;
+    int failed = 0;
+
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        uint64_t index = next_index(&state);
+
+        policy->get(copying, &index);
+
+        size_t hits = policy->get_hits(filling);
+        page_t *page = policy->get(filling, &index);
+        int hit = (policy->get_hits(filling) != hits);
+
+        if (with_failures && FAILING(index)) {
+            failing_gets += 1;
+            failed = (page != NULL || hit);
+            continue;
+        }
+
+        // The page of a miss is the one in the cache, which the next get of the same index returns. Both caches get the
+        // index again, so that they stay the same
+        failed = (!page || page->value[0] != index || page->value[PAGE_WORDS - 1] != index);
+        if (!hit) {
+            policy->get(copying, &index);
+            failed |= (policy->get(filling, &index) != page);
+        }
+    }
+
+    if (failed) {
+        fprintf(stderr, "%s: wrong page after %lu fills\n", policy->name, fills);
+    }
+
+    // Every get of a failing index calls the fill again, and without failures the caches are the same
+    size_t hits = policy->get_hits(filling);
+    if (failed_fills != failing_gets || (!with_failures && hits != policy->get_hits(copying))) {
+        fprintf(stderr, "%s: %lu hits and %lu fills for %lu hits\n", policy->name, hits, fills,
+                policy->get_hits(copying));
+        failed = 1;
+    }
+
+    printf("%s: failures %d, hits %lu, fills %lu, failed %lu\n", policy->name, with_failures, hits, fills,
+           failed_fills);
+
+    policy->free(copying);
+    policy->free(filling);
+
+    return failed;
+}
+
+//============================================================================================================
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        failed |= test_fill(&policies[i], 0);
+        failed |= test_fill(&policies[i], 1);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+#include "gdsf.h"
+
+typedef struct {
+    int value;
+} index_t;
+
+// Indices are owned by the cache, so hash and cmp receive pointers to them
+unsigned long index_hash(index_t *a) {
+    return (unsigned long)(a->value);
+}
+
+int index_cmp(index_t *a, index_t *b) {
+    return (a->value) - (b->value);
+}
+
+void *get_page(index_t *index) {
+    UNUSED_PARAMETER(index);
+    static int a = 5;
+    return &a;
+}
+
+// Every index has its own size, which is the same as in testgen.py
+size_t page_size(index_t *index, void *page) {
+    UNUSED_PARAMETER(page);
+    return 1 + (size_t)(index->value * 7) % 64;
+}
+
+int main() {
+    size_t m = 0, n = 0;
+
+    // Capacity of the cache is in bytes
+    int res = scanf("%lu %lu", &m, &n);
+    if (res != 2) {
+        ERROR("Invalid input\n");
+    }
+
+    gdsf_init_t init = {
+        .cache =
+            {
+                .hash = CACHE_HASH_F(index_hash),
+                .cmp = CACHE_CMP_F(index_cmp),
+                .get = CACHE_GET_F(get_page),
+                .size = 16,
+                .key_size = sizeof(index_t),
+            },
+        .capacity = m,
+        .size = GDSF_SIZE_F(page_size),
+    };
+
+    gdsf_t gdsf = gdsf_init(init);
+
+    for (size_t i = 0; i < n; ++i) {
+        index_t index = {0};
+        if (scanf("%d", &index.value) != 1) {
+            ERROR("Invalid input\n");
+        }
+        gdsf_get(gdsf, &index);
+
+        if (gdsf_get_used(gdsf) > m) {
+            ERROR("Cache is over capacity\n");
+        }
+    }
+
+    printf("%lu %lu\n", gdsf_get_hits(gdsf), gdsf_get_byte_hits(gdsf));
+
+    gdsf_free(gdsf);
+}
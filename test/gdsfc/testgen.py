@@ -0,0 +1,122 @@
+#!/usr/bin/python
+
+import random, sys, getopt, os
+
+usage_string = "testgen.py -n <num> -o output"
+
+
+MAX_REQUEST_VALUE = 200
+MIN_CACHE_CAPACITY = 16
+MAX_CACHE_CAPACITY = 2000
+MAX_REQUESTS_NUMBER = 10000
+
+# Fixed point scale of the priorities, the same as GDSF_PRIORITY_SCALE
+PRIORITY_SCALE = 1 << 24
+
+def PageSize(index):
+    return 1 + (index * 7) % 64
+
+def GenerateTest(test_number, cache_capacity, requests_number):
+    test_str = []
+    test_str.append(str(cache_capacity))
+    test_str.append(str(requests_number))
+
+    for request in range(requests_number):
+        test_str.append(str(random.randint(0, MAX_REQUEST_VALUE)))
+    return test_str
+
+def GenerateRandomTest(test_number):
+    cache_capacity = random.randint(MIN_CACHE_CAPACITY, MAX_CACHE_CAPACITY)
+    requests_number = random.randint(1, MAX_REQUESTS_NUMBER)
+    test_str = GenerateTest(test_number, cache_capacity, requests_number)
+    return test_str
+
+class ENTRY:
+    def __init__(self, index):
+        self.index = index
+        self.size = PageSize(index)
+        self.freq = 0
+        self.weight = 0
+        # Entries with the same weight are evicted in the order they got it
+        self.stamp = 0
+
+def GenerateAnswer(test):
+    cache_capacity = int(test[0])
+    test_list = [int(request) for request in test[2:]]
+
+    entries = {}
+    hits = 0
+    byte_hits = 0
+    age = 0
+    used = 0
+    stamp = 0
+
+    for index in test_list:
+        stamp += 1
+        found = entries.get(index)
+        if found:
+            hits += 1
+            byte_hits += found.size
+            found.freq += 1
+            found.weight = age + found.freq * PRIORITY_SCALE // found.size
+            found.stamp = stamp
+            continue
+
+        entry = ENTRY(index)
+        if entry.size > cache_capacity:
+            continue
+
+        while used + entry.size > cache_capacity:
+            toremove = min(entries.values(), key=lambda e: (e.weight, e.stamp))
+            age = toremove.weight
+            used -= toremove.size
+            del entries[toremove.index]
+
+        entry.freq = 1
+        entry.weight = age + PRIORITY_SCALE // entry.size
+        entry.stamp = stamp
+        entries[index] = entry
+        used += entry.size
+
+    return "{} {}".format(hits, byte_hits)
+
+
+class CmdArgs:
+    number_of_tests = 0
+    output_path = "./resources"
+
+    def __init__(self):
+        pass
+
+def Generate_N_Random_Tests (cmd):
+    for test_number in range(cmd.number_of_tests):
+        test_str = GenerateRandomTest(test_number)
+        with open (os.path.join(cmd.output_path, "test{}.dat".format(test_number)), 'w+') as test_file:
+            test_file.write("{}".format(" ".join(test_str)))
+        answ = GenerateAnswer(test_str)
+        with open (os.path.join(cmd.output_path, "answ{}.dat".format(test_number)), "w+") as answer_file:
+            answer_file.write("{}\n".format(answ))
+
+
+
+def main (argv):
+    cmd = CmdArgs()
+    try:
+        opts, args = getopt.getopt(argv, "hn:o:")
+    except getopt.GetoptError:
+        print(usage_string)
+        sys.exit()
+    for opt, arg in opts:
+        if opt == "-h":
+            print(usage_string)
+            sys.exit()
+        if opt in ("-o", "--output"):
+            cmd.output_path = str(arg)
+        if opt in ("-n", "--number"):
+            cmd.number_of_tests = int(arg)
+
+    Generate_N_Random_Tests (cmd)
+
+
+
+main(sys.argv[1:])
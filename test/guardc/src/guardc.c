@@ -0,0 +1,198 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+#include "lfu.h"
+#include "lfuda.h"
+
+// Read guards are checked with threads that get pages under the lock of the cache and then keep reading them without
+// the lock, while the other threads evict entries. Every word of a page is its index, so a page that has been reused
+// for another entry during a read section is seen as a wrong one. Without readers in other threads the guards must not
+// change the hits
+
+#define PAGE_WORDS 16
+
+typedef struct {
+    uint64_t value[PAGE_WORDS];
+} page_t;
+
+static unsigned long index_hash(uint64_t *a) {
+    return (unsigned long)(*a);
+}
+
+static int index_cmp(uint64_t *a, uint64_t *b) {
+    return (*a != *b);
+}
+
+// Loaders are called under the lock of the cache
+static void *get_page(uint64_t *index) {
+    static page_t page;
+    for (size_t i = 0; i < PAGE_WORDS; ++i) {
+        page.value[i] = *index;
+    }
+    return &page;
+}
+
+#define CACHE_SIZE 64
+#define KEYS       1024
+#define THREADS    4
+#define REQUESTS   20000
+#define CHECKS     8
+
+//============================================================================================================
+
+// All policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get)(void *cache, void *index);
+    size_t (*read_begin)(void *cache);
+    void (*read_end)(void *cache, size_t guard);
+    size_t (*get_hits)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get, lfu_read_begin, lfu_read_end, lfu_get_hits},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get, lfuda_read_begin, lfuda_read_end, lfuda_get_hits},
+};
+
+static cache_init_t cache_init(int read_guards) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = CACHE_SIZE,
+        .data_size = sizeof(page_t),
+        .key_size = sizeof(uint64_t),
+        .read_guards = read_guards,
+    };
+    return init;
+}
+
+// Skewed keys, so that there are both hits and evictions
+static uint64_t next_index(unsigned long long *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = *state >> 33;
+    return r % (1 + r % KEYS);
+}
+
+//============================================================================================================
+
+typedef struct {
+    const policy_t *policy;
+    void *cache;
+    pthread_mutex_t *lock;
+    unsigned long long state;
+    int failed;
+} reader_t;
+
+static void *reader_thread(void *arg_) {
+    reader_t *arg = arg_;
+
+    for (size_t r = 0; r < REQUESTS; ++r) {
+        uint64_t index = next_index(&arg->state);
+
+        size_t guard = arg->policy->read_begin(arg->cache);
+        pthread_mutex_lock(arg->lock);
+        page_t *page = arg->policy->get(arg->cache, &index);
+        pthread_mutex_unlock(arg->lock);
+
+        // Other threads get the lock and evict entries while the page is being read
+        for (size_t c = 0; c < CHECKS; ++c) {
+            for (size_t i = 0; i < PAGE_WORDS; ++i) {
+                arg->failed |= (page->value[i] != index);
+            }
+            sched_yield();
+        }
+
+        arg->policy->read_end(arg->cache, guard);
+    }
+
+    return NULL;
+}
+
+static int test_readers(const policy_t *policy) {
+    void *cache = policy->init(cache_init(1));
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+
+    pthread_t threads[THREADS];
+    reader_t args[THREADS];
+
+    for (size_t t = 0; t < THREADS; ++t) {
+        reader_t arg = {policy, cache, &lock, t + 1, 0};
+        args[t] = arg;
+        if (pthread_create(&threads[t], NULL, reader_thread, &args[t])) {
+            ERROR("Could not create a thread\n");
+        }
+    }
+
+    int failed = 0;
+    for (size_t t = 0; t < THREADS; ++t) {
+        pthread_join(threads[t], NULL);
+        failed |= args[t].failed;
+    }
+
+    if (failed) {
+        fprintf(stderr, "%s: page was overwritten during a read section\n", policy->name);
+    }
+
+    printf("%s: readers %d, hits %lu\n", policy->name, THREADS, policy->get_hits(cache));
+
+    pthread_mutex_destroy(&lock);
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+// Without other readers the pages of evicted entries are reused at once, so the cache behaves as the one without guards
+static int test_single(const policy_t *policy) {
+    void *plain = policy->init(cache_init(0));
+    void *guarded = policy->init(cache_init(1));
+
+    unsigned long long state = 1;
+    int failed = 0;
+
+    for (size_t r = 0; r < REQUESTS; ++r) {
+        uint64_t index = next_index(&state);
+
+        policy->get(plain, &index);
+
+        // Misses return the copy in the cache as well, so the page is the one of the entry
+        size_t guard = policy->read_begin(guarded);
+        page_t *page = policy->get(guarded, &index);
+        failed |= (page == get_page(&index) || page->value[PAGE_WORDS - 1] != index);
+        policy->read_end(guarded, guard);
+    }
+
+    if (failed || policy->get_hits(plain) != policy->get_hits(guarded)) {
+        fprintf(stderr, "%s: guarded cache has %lu hits instead of %lu\n", policy->name, policy->get_hits(guarded),
+                policy->get_hits(plain));
+        failed = 1;
+    }
+
+    policy->free(plain);
+    policy->free(guarded);
+
+    return failed;
+}
+
+//============================================================================================================
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        failed |= test_single(&policies[i]);
+        failed |= test_readers(&policies[i]);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
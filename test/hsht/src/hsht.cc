@@ -1,4 +1,5 @@
 #include "dllist.h"
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <gtest/gtest.h>
@@ -30,8 +31,16 @@ static int entry_cmp(const void *a, const void *b) {
     return first->a - second->a;
 }
 
-TEST(TestHashTab, TestInsert) {
-    hashtab_t table = hashtab_init(1, entry_hash_mod2, entry_cmp, free);
+// All tests are run against every hash table backend
+class TestHashTab : public ::testing::TestWithParam<hashtab_backend_t> {
+  protected:
+    hashtab_t init(size_t initial_size, hash_func_t hash, entry_free_func_t freefunc) {
+        return hashtab_init_backend(GetParam(), initial_size, hash, entry_cmp, freefunc);
+    }
+};
+
+TEST_P(TestHashTab, TestInsert) {
+    hashtab_t table = init(1, entry_hash_mod2, free);
 
     entry_t *insert1 = entry_init(1);
     hashtab_insert(&table, insert1);
@@ -55,8 +64,8 @@ TEST(TestHashTab, TestInsert) {
     hashtab_free(table);
 }
 
-TEST(TastHashTab, TestRemove) {
-    hashtab_t table = hashtab_init(1, entry_hash, entry_cmp, free);
+TEST_P(TestHashTab, TestRemove) {
+    hashtab_t table = init(1, entry_hash, free);
 
     constexpr int testlen = 20;
     constexpr int notinserted = 235;
@@ -79,8 +88,8 @@ TEST(TastHashTab, TestRemove) {
     hashtab_free(table);
 }
 
-TEST(TestHashTab, TestResize) {
-    hashtab_t table = hashtab_init(1, entry_hash, entry_cmp, free);
+TEST_P(TestHashTab, TestResize) {
+    hashtab_t table = init(1, entry_hash, free);
 
     constexpr int testlen = 10;
     for (int i = 0; i < testlen; i++) {
@@ -97,8 +106,8 @@ TEST(TestHashTab, TestResize) {
     hashtab_free(table);
 }
 
-TEST(TestHashTab, TestStat) {
-    hashtab_t table = hashtab_init(1, entry_hash, entry_cmp, free);
+TEST_P(TestHashTab, TestStat) {
+    hashtab_t table = init(1, entry_hash, free);
 
     constexpr int testlen = 50;
     for (int i = 0; i < testlen; i++) {
@@ -124,6 +133,160 @@ TEST(TestHashTab, TestStat) {
     hashtab_free(table);
 }
 
+TEST_P(TestHashTab, TestIntrusive) {
+    hashtab_t table = init(1, entry_hash, nullptr);
+    hashtab_set_owns_nodes(table, 0);
+
+    constexpr int testlen = 10;
+    std::array<entry_t *, testlen> entries;
+    std::array<dl_node_t, testlen> nodes;
+
+    for (int i = 0; i < testlen; i++) {
+        entries[i] = entry_init(i);
+        nodes[i] = hashtab_node_init(entries[i]);
+        hashtab_insert_node(&table, nodes[i]);
+    }
+
+    for (int i = 0; i < testlen; i += 2) {
+        entry_t key{i};
+        ASSERT_EQ(hashtab_remove_node(table, &key), nodes[i]);
+        ASSERT_EQ(hashtab_lookup(table, &key), nullptr);
+    }
+
+    for (int i = 1; i < testlen; i += 2) {
+        entry_t key{i};
+        ASSERT_EQ(hashtab_lookup(table, &key), entries[i]);
+    }
+
+    // Nodes are owned by the caller and must still be valid after the table is freed
+    hashtab_free(table);
+
+    for (int i = 0; i < testlen; i++) {
+        ASSERT_EQ(dl_node_get_data(nodes[i]), entries[i]);
+        dl_node_free(nodes[i], free);
+    }
+}
+
+TEST_P(TestHashTab, TestCollisions) {
+    hashtab_t table = init(1, entry_hash_mod2, free);
+
+    constexpr int testlen = 100;
+    for (int i = 0; i < testlen; i++) {
+        hashtab_insert(&table, entry_init(i));
+    }
+
+    // Remove every third entry, so that removal happens from the middle of the probe sequences
+    for (int i = 0; i < testlen; i += 3) {
+        entry_t key{i};
+        entry_t *entry = static_cast<entry_t *>(hashtab_remove(table, &key));
+        ASSERT_NE(entry, nullptr);
+        ASSERT_EQ(entry->a, i);
+        free(entry);
+    }
+
+    for (int i = 0; i < testlen; i++) {
+        entry_t key{i};
+        entry_t *entry = static_cast<entry_t *>(hashtab_lookup(table, &key));
+        if (i % 3 == 0) {
+            ASSERT_EQ(entry, nullptr);
+        } else {
+            ASSERT_NE(entry, nullptr);
+            ASSERT_EQ(entry->a, i);
+        }
+    }
+
+    hashtab_free(table);
+}
+
+TEST_P(TestHashTab, TestIncrementalResize) {
+    hashtab_t table = init(1, entry_hash, free);
+
+    constexpr int testlen = 1000;
+    size_t max_migrating = 0;
+
+    // Entries must be found and removed while the buckets are being moved to the new array
+    for (int i = 0; i < testlen; i++) {
+        hashtab_insert(&table, entry_init(i));
+
+        hashtab_stat_t stat = hashtab_get_stat(table);
+        ASSERT_LE(stat.migrated, stat.migrating);
+        max_migrating = std::max(max_migrating, stat.migrating);
+
+        entry_t key{i / 2};
+        entry_t *entry = static_cast<entry_t *>(hashtab_lookup(table, &key));
+        if (key.a % 5 == 3 && key.a < i) {
+            ASSERT_EQ(entry, nullptr);
+        } else {
+            ASSERT_NE(entry, nullptr);
+            ASSERT_EQ(entry->a, i / 2);
+        }
+
+        if (i % 5 == 4) {
+            entry_t removed{i - 1};
+            free(hashtab_remove(table, &removed));
+        }
+    }
+
+    if (GetParam() == HASHTAB_CHAINING) {
+        ASSERT_GT(max_migrating, 0);
+    }
+
+    for (int i = 0; i < testlen; i++) {
+        entry_t key{i};
+        entry_t *entry = static_cast<entry_t *>(hashtab_remove(table, &key));
+        if (i % 5 == 3) {
+            ASSERT_EQ(entry, nullptr);
+        } else {
+            ASSERT_NE(entry, nullptr);
+            ASSERT_EQ(entry->a, i);
+        }
+        free(entry);
+    }
+
+    hashtab_stat_t stat = hashtab_get_stat(table);
+    ASSERT_EQ(stat.migrating, 0);
+    ASSERT_EQ(stat.collisions, 0);
+    ASSERT_EQ(stat.inserts, 0);
+    ASSERT_EQ(stat.used, 0);
+
+    hashtab_free(table);
+}
+
+TEST_P(TestHashTab, TestLookupMany) {
+    hashtab_t table = init(1, entry_hash, free);
+
+    constexpr int testlen = 100;
+    for (int i = 0; i < testlen; i += 2) {
+        hashtab_insert(&table, entry_init(i));
+    }
+
+    // Batch is longer than the internal one and every other key is absent
+    std::array<entry_t *, testlen> keys;
+    std::array<const void *, testlen> keyptrs;
+    std::array<void *, testlen> results;
+    for (int i = 0; i < testlen; i++) {
+        keys[i] = entry_init(i);
+        keyptrs[i] = keys[i];
+    }
+
+    hashtab_lookup_many(table, keyptrs.data(), results.data(), testlen);
+
+    for (int i = 0; i < testlen; i++) {
+        ASSERT_EQ(results[i], hashtab_lookup(table, keys[i]));
+        if (i % 2 == 0) {
+            ASSERT_NE(results[i], nullptr);
+            ASSERT_EQ(static_cast<entry_t *>(results[i])->a, i);
+        } else {
+            ASSERT_EQ(results[i], nullptr);
+        }
+        free(keys[i]);
+    }
+
+    hashtab_free(table);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, TestHashTab, ::testing::Values(HASHTAB_CHAINING, HASHTAB_OPEN_ADDRESSING));
+
 // Run all tests
 int main(int argc, char *argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
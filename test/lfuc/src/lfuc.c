@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "dllist.h"
 #include "error.h"
@@ -31,8 +32,10 @@ void print_elem(void *index, FILE *file) {
     fprintf(file, "%d", *((int *)index));
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     size_t m = 0, n = 0;
+    // Optional argument is the number of indices passed to lfu_get_many at once, by default lfu_get is used
+    size_t batch = (argc > 1 ? strtoul(argv[1], NULL, 10) : 0);
 
     int res = scanf("%lu %lu", &m, &n);
     if (res != 2) {
@@ -50,14 +53,24 @@ int main() {
     lfu_t lfu = lfu_init(init);
 
     index_t *array = calloc_checked(n, sizeof(index_t));
+    void **indices = calloc_checked(n, sizeof(void *));
+    void **results = calloc_checked(n, sizeof(void *));
     for (size_t i = 0; i < n; ++i) {
         index_t *index = &array[i];
         if (scanf("%d", &index->value) != 1) {
             ERROR("Invalid input\n");
         }
+        indices[i] = index;
+        if (batch) {
+            continue;
+        }
         lfu_get(lfu, index);
     }
 
+    for (size_t i = 0; batch && i < n; i += batch) {
+        lfu_get_many(lfu, indices + i, results + i, (n - i < batch ? n - i : batch));
+    }
+
 #ifdef DUMP
     output_t output = {0};
     output.file = fopen("dump.dot", "w");
@@ -74,4 +87,6 @@ int main() {
     printf("%lu\n", lfu_get_hits(lfu));
     lfu_free(lfu);
     free(array);
+    free(indices);
+    free(results);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "dllist.h"
 #include "error.h"
@@ -11,12 +12,13 @@ typedef struct {
     int value;
 } index_t;
 
-unsigned long index_hash(index_t **a) {
-    return (unsigned long)((*a)->value);
+// Indices are owned by the cache, so hash and cmp receive pointers to them
+unsigned long index_hash(index_t *a) {
+    return (unsigned long)(a->value);
 }
 
-int index_cmp(index_t **a, index_t **b) {
-    return ((*a)->value) - ((*b)->value);
+int index_cmp(index_t *a, index_t *b) {
+    return (a->value) - (b->value);
 }
 
 void *get_page(index_t *index) {
@@ -29,8 +31,10 @@ void print_data(index_t *index, FILE *file) {
     fprintf(file, "%d", *(int *)index);
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     size_t m = 0, n = 0;
+    // Optional argument is the number of indices passed to lfuda_get_many at once, by default lfuda_get is used
+    size_t batch = (argc > 1 ? strtoul(argv[1], NULL, 10) : 0);
 
     int res = scanf("%lu %lu", &m, &n);
     if (res != 2) {
@@ -43,6 +47,7 @@ int main() {
         .get = CACHE_GET_F(get_page),
         .size = m,
         .data_size = sizeof(index_t),
+        .key_size = sizeof(index_t),
     };
 
     lfuda_t lfu = lfuda_init(init);
@@ -51,14 +56,25 @@ int main() {
     output.print = print_data;
 #endif
 
-    index_t *array = calloc_checked(n, sizeof(index_t));
+    // The cache keeps its own copies of the indices, so only the current batch of them is stored here
+    size_t buffer_size = (batch ? batch : 1);
+    index_t *array = calloc_checked(buffer_size, sizeof(index_t));
+    void **indices = calloc_checked(buffer_size, sizeof(void *));
+    void **results = calloc_checked(buffer_size, sizeof(void *));
     for (size_t i = 0; i < n; ++i) {
         static char buf[128];
         snprintf(buf, 128, "dump%lu.dot", i);
-        index_t *index = &array[i];
+        index_t *index = &array[i % buffer_size];
         if (scanf("%d", &index->value) != 1) {
             ERROR("Invalid input\n");
         }
+        indices[i % buffer_size] = index;
+        if (batch) {
+            if ((i + 1) % batch == 0 || i + 1 == n) {
+                lfuda_get_many(lfu, indices, results, i % batch + 1);
+            }
+            continue;
+        }
         lfuda_get(lfu, index);
 
 #ifdef DUMP
@@ -75,4 +91,6 @@ int main() {
 
     lfuda_free(lfu);
     free(array);
+    free(indices);
+    free(results);
 }
\ No newline at end of file
@@ -5,8 +5,14 @@ green=`tput setaf 2`
 reset=`tput sgr0`
 
 current_folder=${2:-./}
+# Optional batch size that is passed to the executable
+batch=$3
 passed=true
 
+# Output goes to a file of its own outside of the sources, so that the runs of the test can go in parallel
+output=`mktemp`
+trap 'rm -f "$output"' EXIT
+
 for file in ${current_folder}/${base_folder}/test*.dat; do
 
     # Total number of the tests found
@@ -16,13 +22,13 @@ for file in ${current_folder}/${base_folder}/test*.dat; do
 
     # Check if an argument to executable location has been passed to the program
     if [ -z "$1" ]; then
-        bin/lfudac < $file > ${current_folder}/$base_folder/temp.dat
+        bin/lfudac $batch < $file > $output
     else
-        $1 < $file > ${current_folder}/$base_folder/temp.dat
+        $1 $batch < $file > $output
     fi
 
     # Compare inputs
-    if diff ${current_folder}/${base_folder}/answ${count}.dat ${current_folder}/${base_folder}/temp.dat; then
+    if diff ${current_folder}/${base_folder}/answ${count}.dat $output; then
         echo "${green}Passed${reset}"
     else
         echo "${red}Failed${reset}"
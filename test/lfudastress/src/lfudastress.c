@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lfuda.h"
+
+// LFU-DA only compares keys with each other, so shifting age of a cache must not change which requests hit. The same
+// trace is run against caches starting at different ages, including ones that cross 2^31 and 2^32 and ones that are
+// renormalised, and every request must hit or miss in all of them at once
+
+typedef struct {
+    int value;
+} index_t;
+
+static unsigned long index_hash(index_t *a) {
+    return (unsigned long)(a->value);
+}
+
+static int index_cmp(index_t *a, index_t *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+static unsigned long long rand_state = 42;
+
+// Skewed keys, so that there are both frequently and rarely used entries
+static int next_index(void) {
+    rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = rand_state >> 33;
+    return (int)(r % (1 + r % 4096));
+}
+
+#define CACHE_SIZE 64
+#define REQUESTS 400000
+// Age of a cache must grow by more than this during the trace
+#define AGE_MARGIN 1000
+
+int main(void) {
+    // The first cache is the reference, it starts at zero and is never renormalised
+    size_t start[] = {
+        0,
+        (size_t)INT32_MAX - AGE_MARGIN,
+        (size_t)UINT32_MAX - AGE_MARGIN,
+        SIZE_MAX / 2 - AGE_MARGIN,
+        0,
+    };
+    size_t renormalize[] = {0, 0, 0, SIZE_MAX / 2, 100};
+    const size_t ncaches = sizeof(start) / sizeof(start[0]);
+
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .size = CACHE_SIZE,
+        .key_size = sizeof(index_t),
+    };
+
+    lfuda_t caches[sizeof(start) / sizeof(start[0])];
+    for (size_t i = 0; i < ncaches; ++i) {
+        caches[i] = lfuda_init(init);
+        lfuda_set_age(caches[i], start[i]);
+        lfuda_set_renormalize(caches[i], renormalize[i]);
+    }
+
+    int failed = 0;
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        index_t index = {next_index()};
+        for (size_t i = 0; i < ncaches; ++i) {
+            lfuda_get(caches[i], &index);
+            if (lfuda_get_hits(caches[i]) != lfuda_get_hits(caches[0])) {
+                fprintf(stderr, "Cache %lu diverged at request %lu (age %lu)\n", i, r, lfuda_get_age(caches[i]));
+                failed = 1;
+                break;
+            }
+        }
+    }
+
+    size_t grown = lfuda_get_age(caches[0]);
+    printf("hits %lu, age %lu\n", lfuda_get_hits(caches[0]), grown);
+
+    if (!failed && grown <= AGE_MARGIN) {
+        fprintf(stderr, "Age did not grow enough to cross the limits\n");
+        failed = 1;
+    }
+
+    // Caches that are not renormalised must have been shifted by exactly their starting age
+    for (size_t i = 0; i < ncaches && !failed; ++i) {
+        if (!renormalize[i] && lfuda_get_age(caches[i]) != start[i] + grown) {
+            fprintf(stderr, "Cache %lu has age %lu instead of %lu\n", i, lfuda_get_age(caches[i]), start[i] + grown);
+            failed = 1;
+        }
+    }
+
+    for (size_t i = 0; i < ncaches; ++i) {
+        lfuda_free(caches[i]);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
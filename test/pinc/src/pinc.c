@@ -0,0 +1,284 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+#include "lfu.h"
+#include "lfuda.h"
+
+// Pinned entries must survive any number of misses with their pages in place, while their hits are still counted. When
+// every entry is pinned, misses must be rejected instead of evicting one of them, and an unpinned entry must be evicted
+// as usual, also after the frequency node it was pinned from has been freed. Pins are checked with every way of storing
+// fixed size pages
+
+#define PAGE_WORDS 4
+
+typedef struct {
+    uint64_t value[PAGE_WORDS];
+} page_t;
+
+static unsigned long index_hash(uint64_t *a) {
+    return (unsigned long)(*a);
+}
+
+static int index_cmp(uint64_t *a, uint64_t *b) {
+    return (*a != *b);
+}
+
+static void *get_page(uint64_t *index) {
+    static page_t page;
+    for (size_t i = 0; i < PAGE_WORDS; ++i) {
+        page.value[i] = *index;
+    }
+    return &page;
+}
+
+static int fill_page(uint64_t *index, void *dst, size_t cap) {
+    (void)cap;
+    *(page_t *)dst = *(page_t *)get_page(index);
+    return 0;
+}
+
+#define CACHE_SIZE 128
+#define KEYS       2048
+#define REQUESTS   100000
+#define PINNED     16
+
+// Skewed keys, so that there are both hits and evictions
+static uint64_t next_index(unsigned long long *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = *state >> 33;
+    return r % (1 + r % KEYS);
+}
+
+static int page_is(page_t *page, uint64_t index) {
+    return (page && page->value[0] == index && page->value[PAGE_WORDS - 1] == index);
+}
+
+//============================================================================================================
+
+// All policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get)(void *cache, void *index);
+    int (*put)(void *cache, void *index, void *page);
+    void *(*peek)(void *cache, void *index);
+    int (*contains)(void *cache, void *index);
+    int (*erase)(void *cache, void *index);
+    void *(*pin)(void *cache, void *index);
+    void (*unpin)(void *cache, void *index);
+    size_t (*get_hits)(void *cache);
+    size_t (*get_rejected)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get, lfu_put, lfu_peek, lfu_contains, lfu_erase, lfu_pin, lfu_unpin,
+     lfu_get_hits, lfu_get_rejected},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get, lfuda_put, lfuda_peek, lfuda_contains, lfuda_erase, lfuda_pin,
+     lfuda_unpin, lfuda_get_hits, lfuda_get_rejected},
+};
+
+static cache_init_t cache_init(void) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = CACHE_SIZE,
+        .data_size = sizeof(page_t),
+        .key_size = sizeof(uint64_t),
+    };
+    return init;
+}
+
+//============================================================================================================
+
+// Indices that are never requested otherwise are pinned, so they would be the first to go without pins
+static int test_survive(const policy_t *policy, cache_init_t init, const char *variant) {
+    void *cache = policy->init(init);
+
+    page_t *pages[PINNED];
+    int failed = 0;
+
+    for (uint64_t i = 0; i < PINNED; ++i) {
+        uint64_t index = KEYS + i;
+        pages[i] = policy->pin(cache, &index);
+        failed |= !page_is(pages[i], index);
+    }
+
+    // The first one is pinned twice, so it stays pinned after one unpin
+    uint64_t twice = KEYS;
+    failed |= (policy->pin(cache, &twice) != pages[0]);
+    policy->unpin(cache, &twice);
+
+    unsigned long long state = 1;
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        uint64_t index = next_index(&state);
+        failed |= !page_is(policy->get(cache, &index), index);
+    }
+
+    // Pinned entries are neither evicted nor erased, and their pages stay where they were
+    for (uint64_t i = 0; i < PINNED; ++i) {
+        uint64_t index = KEYS + i;
+        failed |= (policy->peek(cache, &index) != pages[i] || !page_is(pages[i], index));
+        failed |= policy->erase(cache, &index);
+    }
+
+    // Their hits are counted as any others, and puts overwrite their pages in place
+    size_t hits = policy->get_hits(cache);
+    for (uint64_t i = 0; i < PINNED; ++i) {
+        uint64_t index = KEYS + i, other = 2 * KEYS + i;
+        failed |= (policy->get(cache, &index) != pages[i]);
+        failed |= !policy->put(cache, &index, get_page(&other));
+        failed |= !page_is(pages[i], other);
+    }
+    failed |= (policy->get_hits(cache) != hits + PINNED || policy->get_rejected(cache));
+
+    if (failed) {
+        fprintf(stderr, "%s %s: pinned entries were evicted or moved\n", policy->name, variant);
+    }
+
+    // After the unpins they are ordinary entries, which can be erased
+    for (uint64_t i = 0; i < PINNED; ++i) {
+        uint64_t index = KEYS + i;
+        policy->unpin(cache, &index);
+        if (!policy->erase(cache, &index)) {
+            fprintf(stderr, "%s %s: unpinned entry %lu was not erased\n", policy->name, variant, index);
+            failed = 1;
+        }
+    }
+
+    printf("%s %s: %lu hits with %d pinned\n", policy->name, variant, policy->get_hits(cache), PINNED);
+
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+// A cache whose every entry is pinned rejects misses, until one of them is unpinned
+static int test_rejected(const policy_t *policy, cache_init_t init, const char *variant) {
+    void *cache = policy->init(init);
+
+    int failed = 0;
+
+    for (uint64_t index = 0; index < CACHE_SIZE; ++index) {
+        failed |= !page_is(policy->pin(cache, &index), index);
+    }
+
+    // The misses still get the page of the loader, which is not inserted
+    uint64_t index = CACHE_SIZE;
+    page_t *page = policy->get(cache, &index);
+    failed |= (init.fill ? page != NULL : !page_is(page, index));
+    failed |= (policy->pin(cache, &index) != NULL);
+    failed |= policy->put(cache, &index, get_page(&index));
+    failed |= (policy->contains(cache, &index) || policy->get_rejected(cache) != 3);
+
+    // The only entry that is not pinned is the one to evict
+    uint64_t unpinned = CACHE_SIZE / 2;
+    policy->unpin(cache, &unpinned);
+    failed |= !page_is(policy->get(cache, &index), index);
+    failed |= (policy->contains(cache, &unpinned) || policy->get_rejected(cache) != 3);
+
+    if (failed) {
+        fprintf(stderr, "%s %s: misses of a pinned cache were not rejected\n", policy->name, variant);
+    }
+
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+// The node an entry was pinned from is freed and reused while it is pinned, and the unpinned entry must still get the
+// node of its frequency instead of one at the head of the list, where it would be evicted first
+static int test_unpin_reused(const policy_t *policy, cache_init_t init, const char *variant) {
+    void *cache = policy->init(init);
+
+    int failed = 0;
+
+    // The entry is pinned from a node of its own, whose predecessor has all of the other entries
+    uint64_t pinned = 0;
+    for (uint64_t index = 0; index < CACHE_SIZE; ++index) {
+        failed |= !page_is(policy->get(cache, &index), index);
+    }
+    policy->get(cache, &pinned);
+    policy->get(cache, &pinned);
+    policy->pin(cache, &pinned);
+
+    // The other entries move up, so both nodes are freed and their storage is reused for the new keys
+    for (uint64_t index = 1; index < CACHE_SIZE; ++index) {
+        policy->get(cache, &index);
+        policy->get(cache, &index);
+        policy->get(cache, &index);
+    }
+
+    // Pinned hits raise the frequency of the entry above all others
+    for (int i = 0; i < CACHE_SIZE; ++i) {
+        policy->get(cache, &pinned);
+    }
+    policy->unpin(cache, &pinned);
+
+    // Misses of new indices evict each other and the entry survives them
+    for (uint64_t index = KEYS; index < KEYS + CACHE_SIZE / 2; ++index) {
+        failed |= !page_is(policy->get(cache, &index), index);
+    }
+    failed |= !policy->contains(cache, &pinned);
+
+    // The entry is back in the eviction lists, so it is the one to evict when all of the others are pinned
+    for (uint64_t index = 1; index < KEYS + CACHE_SIZE; ++index) {
+        if (policy->contains(cache, &index)) {
+            policy->pin(cache, &index);
+        }
+    }
+    uint64_t miss = 2 * KEYS;
+    failed |= !page_is(policy->get(cache, &miss), miss);
+    failed |= (policy->contains(cache, &pinned) || policy->get_rejected(cache));
+
+    if (failed) {
+        fprintf(stderr, "%s %s: unpinned entry lost its frequency\n", policy->name, variant);
+    }
+
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        const policy_t *policy = &policies[i];
+
+        cache_init_t init = cache_init();
+        failed |= test_survive(policy, init, "plain");
+        failed |= test_rejected(policy, init, "plain");
+        failed |= test_unpin_reused(policy, init, "plain");
+
+        init.admission = 1;
+        failed |= test_survive(policy, init, "admission");
+        failed |= test_rejected(policy, init, "admission");
+        failed |= test_unpin_reused(policy, init, "admission");
+
+        init = cache_init();
+        init.read_guards = 1;
+        failed |= test_survive(policy, init, "guarded");
+        failed |= test_rejected(policy, init, "guarded");
+        failed |= test_unpin_reused(policy, init, "guarded");
+
+        init = cache_init();
+        init.get = NULL;
+        init.fill = CACHE_FILL_F(fill_page);
+        failed |= test_survive(policy, init, "filled");
+        failed |= test_rejected(policy, init, "filled");
+        failed |= test_unpin_reused(policy, init, "filled");
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
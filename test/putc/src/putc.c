@@ -0,0 +1,265 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+#include "lfu.h"
+#include "lfuda.h"
+
+// Explicit operations are checked against gets. Peeks and contains must not change what a cache evicts, puts must
+// insert and promote entries as gets do without counting hits, and erases must free slots, so that the next new entries
+// do not evict anything. Erases are checked with every way of storing fixed size pages
+
+#define PAGE_WORDS 4
+
+typedef struct {
+    uint64_t value[PAGE_WORDS];
+} page_t;
+
+static unsigned long index_hash(uint64_t *a) {
+    return (unsigned long)(*a);
+}
+
+static int index_cmp(uint64_t *a, uint64_t *b) {
+    return (*a != *b);
+}
+
+static void *get_page(uint64_t *index) {
+    static page_t page;
+    for (size_t i = 0; i < PAGE_WORDS; ++i) {
+        page.value[i] = *index;
+    }
+    return &page;
+}
+
+static int fill_page(uint64_t *index, void *dst, size_t cap) {
+    (void)cap;
+    *(page_t *)dst = *(page_t *)get_page(index);
+    return 0;
+}
+
+#define CACHE_SIZE 128
+#define KEYS       2048
+#define REQUESTS   100000
+#define ERASED     16
+
+// Skewed keys, so that there are both hits and evictions
+static uint64_t next_index(unsigned long long *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = *state >> 33;
+    return r % (1 + r % KEYS);
+}
+
+static int page_is(page_t *page, uint64_t index) {
+    return (page && page->value[0] == index && page->value[PAGE_WORDS - 1] == index);
+}
+
+//============================================================================================================
+
+// All policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get)(void *cache, void *index);
+    int (*put)(void *cache, void *index, void *page);
+    void *(*peek)(void *cache, void *index);
+    int (*contains)(void *cache, void *index);
+    int (*erase)(void *cache, void *index);
+    size_t (*get_hits)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get, lfu_put, lfu_peek, lfu_contains, lfu_erase, lfu_get_hits},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get, lfuda_put, lfuda_peek, lfuda_contains, lfuda_erase, lfuda_get_hits},
+};
+
+static cache_init_t cache_init(void) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = CACHE_SIZE,
+        .data_size = sizeof(page_t),
+        .key_size = sizeof(uint64_t),
+    };
+    return init;
+}
+
+// Both caches must hold the same indices
+static int same_indices(const policy_t *policy, void *a, void *b) {
+    for (uint64_t index = 0; index < KEYS; ++index) {
+        if (policy->contains(a, &index) != policy->contains(b, &index)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//============================================================================================================
+
+// Peeks and contains of any index between the gets do not change the cache
+static int test_peek(const policy_t *policy) {
+    void *plain = policy->init(cache_init());
+    void *peeked = policy->init(cache_init());
+
+    unsigned long long state = 1, peeks = 2;
+    int failed = 0;
+
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        uint64_t index = next_index(&state);
+        policy->get(plain, &index);
+        policy->get(peeked, &index);
+
+        uint64_t probe = next_index(&peeks);
+        page_t *page = policy->peek(peeked, &probe);
+        failed = (policy->contains(peeked, &probe) ? !page_is(page, probe) : page != NULL);
+    }
+
+    if (failed || policy->get_hits(plain) != policy->get_hits(peeked) || !same_indices(policy, plain, peeked)) {
+        fprintf(stderr, "%s: peeks changed the cache\n", policy->name);
+        failed = 1;
+    }
+
+    policy->free(plain);
+    policy->free(peeked);
+
+    return failed;
+}
+
+//============================================================================================================
+
+// A cache without a loader that gets every page by put holds the same entries as the one with gets
+static int test_put(const policy_t *policy) {
+    cache_init_t init = cache_init();
+    void *loaded = policy->init(init);
+
+    init.get = NULL;
+    void *populated = policy->init(init);
+
+    unsigned long long state = 1;
+    int failed = 0;
+
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        uint64_t index = next_index(&state);
+        policy->get(loaded, &index);
+
+        // Misses of a cache without a loader return NULL and insert nothing
+        int resident = policy->contains(populated, &index);
+        page_t *page = policy->peek(populated, &index);
+        if (!resident) {
+            failed |= (policy->get(populated, &index) != NULL || policy->contains(populated, &index));
+            failed |= (page != NULL);
+        }
+
+        policy->put(populated, &index, get_page(&index));
+        failed |= !page_is(policy->peek(populated, &index), index);
+    }
+
+    if (failed || policy->get_hits(populated) || !same_indices(policy, loaded, populated)) {
+        fprintf(stderr, "%s: puts differ from gets\n", policy->name);
+        failed = 1;
+    }
+
+    // Puts overwrite pages of resident indices
+    uint64_t index = next_index(&state);
+    policy->put(populated, &index, get_page(&index));
+    uint64_t other = index + KEYS;
+    policy->put(populated, &index, get_page(&other));
+    if (!page_is(policy->get(populated, &index), other)) {
+        fprintf(stderr, "%s: put did not overwrite the page\n", policy->name);
+        failed = 1;
+    }
+
+    policy->free(loaded);
+    policy->free(populated);
+
+    return failed;
+}
+
+//============================================================================================================
+
+// Erased entries leave free slots, so after the cache is full the next new entries evict nothing
+static int test_erase(const policy_t *policy, cache_init_t init, const char *variant) {
+    void *cache = policy->init(init);
+
+    unsigned long long state = 1;
+    int failed = 0;
+
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        uint64_t index = next_index(&state);
+        failed |= !page_is(policy->get(cache, &index), index);
+
+        // Erase some of the resident indices from time to time
+        if (r % 7 == 0) {
+            uint64_t erased = next_index(&state);
+            int resident = policy->contains(cache, &erased);
+            failed |= (policy->erase(cache, &erased) != resident);
+            failed |= (policy->contains(cache, &erased) || policy->erase(cache, &erased));
+        }
+    }
+
+    // Make room and insert as many new indices as there are free slots, which must not evict any of the others
+    size_t erased = 0;
+    for (uint64_t index = 0; index < KEYS && erased < ERASED; ++index) {
+        erased += policy->erase(cache, &index);
+    }
+
+    static int kept[KEYS];
+    size_t resident = 0;
+    for (uint64_t index = 0; index < KEYS; ++index) {
+        kept[index] = policy->contains(cache, &index);
+        resident += kept[index];
+    }
+
+    for (uint64_t index = KEYS; index < KEYS + CACHE_SIZE - resident; ++index) {
+        failed |= !page_is(policy->get(cache, &index), index);
+    }
+
+    for (uint64_t index = 0; index < KEYS + CACHE_SIZE - resident; ++index) {
+        int expected = (index >= KEYS || kept[index]);
+        failed |= (policy->contains(cache, &index) != expected);
+        failed |= (expected && !page_is(policy->peek(cache, &index), index));
+    }
+
+    if (failed || erased != ERASED) {
+        fprintf(stderr, "%s %s: entries were evicted or damaged after erases\n", policy->name, variant);
+        failed = 1;
+    }
+
+    printf("%s %s: %lu resident after erases\n", policy->name, variant, resident);
+
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        const policy_t *policy = &policies[i];
+        failed |= test_peek(policy);
+        failed |= test_put(policy);
+
+        cache_init_t init = cache_init();
+        failed |= test_erase(policy, init, "plain");
+
+        init.admission = 1;
+        failed |= test_erase(policy, init, "admission");
+
+        init = cache_init();
+        init.read_guards = 1;
+        failed |= test_erase(policy, init, "guarded");
+
+        init = cache_init();
+        init.get = NULL;
+        init.fill = CACHE_FILL_F(fill_page);
+        failed |= test_erase(policy, init, "filled");
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
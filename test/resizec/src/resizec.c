@@ -0,0 +1,386 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+#include "lfu.h"
+#include "lfuda.h"
+
+// Capacity changes are checked on live caches. Grown caches must take new entries without evictions until they are full
+// again, and shrunk caches must evict a few entries on every get, the least frequently used ones first, until they fit.
+// Batches got while they shrink must leave them as the same gets one by one do. Random changes of the capacity with
+// every way of storing fixed size pages must keep all pages right
+
+#define PAGE_WORDS 4
+
+typedef struct {
+    uint64_t value[PAGE_WORDS];
+} page_t;
+
+// Number of hashes, so that hits can be checked to look up their index only once
+static size_t hashes = 0;
+
+static unsigned long index_hash(uint64_t *a) {
+    hashes++;
+    return (unsigned long)(*a);
+}
+
+static int index_cmp(uint64_t *a, uint64_t *b) {
+    return (*a != *b);
+}
+
+static void *get_page(uint64_t *index) {
+    static page_t page;
+    for (size_t i = 0; i < PAGE_WORDS; ++i) {
+        page.value[i] = *index;
+    }
+    return &page;
+}
+
+static int fill_page(uint64_t *index, void *dst, size_t cap) {
+    (void)cap;
+    *(page_t *)dst = *(page_t *)get_page(index);
+    return 0;
+}
+
+static int page_is(page_t *page, uint64_t index) {
+    return (page && page->value[0] == index && page->value[PAGE_WORDS - 1] == index);
+}
+
+#define SMALL    128
+#define LARGE    1024
+#define KEYS     8192
+#define REQUESTS 200000
+
+// Number of entries a single step of shrinking evicts, and the largest number of entries a single get may evict after a
+// shrink, including the one of its own miss
+#define SHRINK_STEP 8
+#define MAX_EVICTED (SHRINK_STEP + 1)
+
+// Skewed keys, so that there are both hits and evictions
+static uint64_t next_index(unsigned long long *state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = *state >> 33;
+    return r % (1 + r % KEYS);
+}
+
+//============================================================================================================
+
+// All policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get)(void *cache, void *index);
+    void *(*peek)(void *cache, void *index);
+    int (*contains)(void *cache, void *index);
+    void (*set_capacity)(void *cache, size_t size);
+    int (*shrink)(void *cache);
+    int (*erase)(void *cache, void *index);
+    void (*get_many)(void *cache, void **indices, void **results, size_t count);
+    size_t (*get_hits)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get, lfu_peek, lfu_contains, lfu_set_capacity, lfu_shrink, lfu_erase,
+     lfu_get_many, lfu_get_hits},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get, lfuda_peek, lfuda_contains, lfuda_set_capacity, lfuda_shrink,
+     lfuda_erase, lfuda_get_many, lfuda_get_hits},
+};
+
+static cache_init_t cache_init(size_t size) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = size,
+        .data_size = sizeof(page_t),
+        .key_size = sizeof(uint64_t),
+    };
+    return init;
+}
+
+static size_t resident(const policy_t *policy, void *cache) {
+    size_t count = 0;
+    for (uint64_t index = 0; index < KEYS; ++index) {
+        count += policy->contains(cache, &index);
+    }
+    return count;
+}
+
+//============================================================================================================
+
+// Index k of LARGE ones is got 1 + k / SMALL times, so that the SMALL last ones are the most frequent
+static void fill_by_frequency(const policy_t *policy, void *cache) {
+    for (uint64_t index = 0; index < LARGE; ++index) {
+        for (size_t i = 0; i <= index / SMALL; ++i) {
+            policy->get(cache, &index);
+        }
+    }
+}
+
+static int test_grow(const policy_t *policy) {
+    void *cache = policy->init(cache_init(SMALL));
+    int failed = 0;
+
+    fill_by_frequency(policy, cache);
+    policy->set_capacity(cache, LARGE);
+
+    // Nothing is evicted until the grown cache is full
+    for (uint64_t index = LARGE; index < LARGE + LARGE - SMALL; ++index) {
+        failed |= !page_is(policy->get(cache, &index), index);
+    }
+
+    failed |= (resident(policy, cache) != LARGE);
+    for (uint64_t index = LARGE - SMALL; index < LARGE + LARGE - SMALL; ++index) {
+        failed |= !page_is(policy->peek(cache, &index), index);
+    }
+
+    if (failed) {
+        size_t count = resident(policy, cache);
+        fprintf(stderr, "%s: grown cache has %lu entries instead of %d\n", policy->name, count, LARGE);
+    }
+
+    policy->free(cache);
+
+    return failed;
+}
+
+static int test_shrink(const policy_t *policy) {
+    void *cache = policy->init(cache_init(LARGE));
+    int failed = 0;
+
+    fill_by_frequency(policy, cache);
+    policy->set_capacity(cache, SMALL);
+    failed |= (resident(policy, cache) != LARGE);
+
+    // Gets of the most frequent index evict a few entries each, until only the most frequent ones are left
+    size_t gets = 0;
+    for (size_t count = LARGE; count > SMALL; ++gets) {
+        uint64_t index = LARGE - 1;
+        failed |= !page_is(policy->get(cache, &index), index);
+
+        size_t now = resident(policy, cache);
+        failed |= (now >= count || now + MAX_EVICTED < count);
+        count = now;
+    }
+
+    for (uint64_t index = 0; index < LARGE; ++index) {
+        failed |= (policy->contains(cache, &index) != (index >= LARGE - SMALL));
+    }
+
+    if (failed) {
+        fprintf(stderr, "%s: shrunk cache did not evict the least frequent entries gradually\n", policy->name);
+    }
+
+    printf("%s: shrunk from %d to %d entries in %lu gets\n", policy->name, LARGE, SMALL, gets);
+
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+// Idle caches are shrunk by explicit steps, and erases continue shrinking the same way as gets. A grown cache is shrunk
+// back below its initial capacity, so that the pages of the grown entries are freed
+static int test_shrink_idle(const policy_t *policy, cache_init_t init, const char *variant) {
+    void *cache = policy->init(init);
+    int failed = 0;
+
+    policy->set_capacity(cache, LARGE);
+    fill_by_frequency(policy, cache);
+    policy->set_capacity(cache, SMALL / 2);
+
+    // Every step evicts a few entries, and the last one reports that there is nothing left to do
+    size_t steps = 0;
+    while (policy->shrink(cache)) {
+        steps++;
+    }
+
+    failed |= (steps < (LARGE - SMALL / 2) / MAX_EVICTED || policy->shrink(cache));
+    for (uint64_t index = 0; index < LARGE; ++index) {
+        failed |= (policy->contains(cache, &index) != (index >= LARGE - SMALL / 2));
+    }
+
+    // Once shrinking has finished, hits look up their index once, as they did before the capacity was changed
+    size_t before = hashes;
+    for (uint64_t index = LARGE - SMALL / 2; index < LARGE; ++index) {
+        failed |= !page_is(policy->get(cache, &index), index);
+    }
+    failed |= (hashes - before != SMALL / 2);
+
+    // An erase evicts as many entries over the new capacity as a get does
+    policy->set_capacity(cache, SMALL / 4);
+    uint64_t erased = LARGE - 1;
+    failed |= !policy->erase(cache, &erased);
+    failed |= (resident(policy, cache) != SMALL / 2 - MAX_EVICTED);
+    while (policy->shrink(cache)) {
+    }
+    failed |= (resident(policy, cache) != SMALL / 4);
+
+    // The cache grows again with pages that are allocated as they are needed
+    policy->set_capacity(cache, LARGE);
+    fill_by_frequency(policy, cache);
+    failed |= (resident(policy, cache) != LARGE);
+    for (uint64_t index = 0; index < LARGE; ++index) {
+        failed |= !page_is(policy->peek(cache, &index), index);
+    }
+
+    if (failed) {
+        fprintf(stderr, "%s %s: idle cache was not shrunk by steps and erases\n", policy->name, variant);
+    }
+
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+#define BATCH 32
+
+// Batches that are got while a shrunk cache is still evicting must give the same pages, hits and entries as the same
+// gets one by one, although the gets of a batch evict entries that the batch has already looked up
+static int test_shrink_batched(const policy_t *policy) {
+    void *batched = policy->init(cache_init(SMALL));
+    void *single = policy->init(cache_init(SMALL));
+    int failed = 0;
+
+    unsigned long long state = 1;
+    uint64_t keys[BATCH];
+    void *indices[BATCH], *results[BATCH];
+
+    // The entries over the initial capacity are the least frequent ones, so that the slots of their grown pages are
+    // given back as soon as they are evicted
+    policy->set_capacity(batched, SMALL + SHRINK_STEP);
+    policy->set_capacity(single, SMALL + SHRINK_STEP);
+    for (uint64_t index = 0; index < SMALL + SHRINK_STEP; ++index) {
+        for (int i = 0; i < (index < SMALL ? 2 : 1); ++i) {
+            policy->get(batched, &index);
+            policy->get(single, &index);
+        }
+    }
+
+    // A single step finishes shrinking, which the first get of the batch takes. It is a hit, and the step evicts the
+    // entries that the batch gets next
+    policy->set_capacity(batched, SMALL);
+    policy->set_capacity(single, SMALL);
+    for (size_t i = 0; i <= SHRINK_STEP; ++i) {
+        keys[i] = (i ? SMALL + i - 1 : 0);
+        indices[i] = &keys[i];
+    }
+    policy->get_many(batched, indices, results, SHRINK_STEP + 1);
+    for (size_t i = 0; i <= SHRINK_STEP; ++i) {
+        failed |= !page_is(policy->get(single, &keys[i]), keys[i]);
+    }
+    failed |= (policy->get_hits(batched) != policy->get_hits(single));
+    for (uint64_t index = 0; index < SMALL + SHRINK_STEP; ++index) {
+        failed |= (policy->contains(batched, &index) != policy->contains(single, &index));
+    }
+
+    // Then the cache is shrunk by many steps, which are taken by gets of random batches
+    policy->set_capacity(batched, LARGE);
+    policy->set_capacity(single, LARGE);
+    fill_by_frequency(policy, batched);
+    fill_by_frequency(policy, single);
+    policy->set_capacity(batched, SMALL / 2);
+    policy->set_capacity(single, SMALL / 2);
+
+    for (size_t r = 0; r < REQUESTS / 10 && !failed; r += BATCH) {
+        for (size_t i = 0; i < BATCH; ++i) {
+            keys[i] = next_index(&state) % LARGE;
+            indices[i] = &keys[i];
+        }
+
+        // Later gets may evict the entries of earlier ones and reuse their pages, so only the last page is still valid
+        policy->get_many(batched, indices, results, BATCH);
+        for (size_t i = 0; i < BATCH; ++i) {
+            failed |= !page_is(policy->get(single, &keys[i]), keys[i]);
+        }
+        failed |= !page_is(results[BATCH - 1], keys[BATCH - 1]);
+        failed |= (policy->get_hits(batched) != policy->get_hits(single));
+
+        for (uint64_t index = 0; index < LARGE; ++index) {
+            failed |= (policy->contains(batched, &index) != policy->contains(single, &index));
+        }
+    }
+
+    if (failed) {
+        fprintf(stderr, "%s: batched gets of a shrinking cache differ from single gets\n", policy->name);
+    }
+
+    policy->free(batched);
+    policy->free(single);
+
+    return failed;
+}
+
+//============================================================================================================
+
+// Capacity changes at random during a workload, while every page must stay right
+static int test_random(const policy_t *policy, cache_init_t init, const char *variant) {
+    void *cache = policy->init(init);
+
+    unsigned long long state = 1, sizes = 2;
+    size_t size = init.size;
+    int failed = 0;
+
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        if (r % 5000 == 0) {
+            size = 2 + next_index(&sizes) % LARGE;
+            policy->set_capacity(cache, size);
+        }
+
+        uint64_t index = next_index(&state);
+        failed |= !page_is(policy->get(cache, &index), index);
+    }
+
+    // Entries that are left from before the last change are evicted by the gets of the last 5000 requests
+    size_t count = resident(policy, cache);
+    for (uint64_t index = 0; index < KEYS; ++index) {
+        failed |= (policy->contains(cache, &index) && !page_is(policy->peek(cache, &index), index));
+    }
+
+    if (failed || count > size) {
+        fprintf(stderr, "%s %s: %lu entries for capacity %lu\n", policy->name, variant, count, size);
+        failed = 1;
+    }
+
+    policy->free(cache);
+
+    return failed;
+}
+
+//============================================================================================================
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        const policy_t *policy = &policies[i];
+        failed |= test_grow(policy);
+        failed |= test_shrink(policy);
+        failed |= test_shrink_batched(policy);
+
+        cache_init_t init = cache_init(SMALL);
+        failed |= test_shrink_idle(policy, init, "plain");
+        failed |= test_random(policy, init, "plain");
+
+        init.admission = 1;
+        failed |= test_random(policy, init, "admission");
+
+        init = cache_init(SMALL);
+        init.read_guards = 1;
+        failed |= test_shrink_idle(policy, init, "guarded");
+        failed |= test_random(policy, init, "guarded");
+
+        init = cache_init(SMALL);
+        init.get = NULL;
+        init.fill = CACHE_FILL_F(fill_page);
+        failed |= test_random(policy, init, "filled");
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#!/usr/bin/python
+
+import random, sys, getopt, os
+
+usage_string = "testgen.py -n <num> -o output"
+
+
+MAX_REQUEST_VALUE = 200
+MAX_CACHE_SIZE = 100
+MAX_REQUESTS_NUMBER = 10000
+
+def GenerateTest(test_number, cache_size, requests_number):
+    test_str = []
+    test_str.append(str(cache_size))
+    test_str.append(str(requests_number))
+
+    # Mix of a frequently used set and scans, so that the visited bits both save entries and get cleared
+    hot = random.sample(range(MAX_REQUEST_VALUE + 1), random.randint(1, MAX_REQUEST_VALUE // 2))
+    for request in range(requests_number):
+        if random.random() < 0.5:
+            test_str.append(str(random.choice(hot)))
+        else:
+            test_str.append(str(random.randint(0, MAX_REQUEST_VALUE)))
+    return test_str
+
+def GenerateRandomTest(test_number):
+    cache_size = random.randint(1, MAX_CACHE_SIZE)
+    requests_number = random.randint(1, MAX_REQUESTS_NUMBER)
+    test_str = GenerateTest(test_number, cache_size, requests_number)
+    return test_str
+
+# Queue keeps the newest entry first, the hand walks from the end of the queue to its start
+class SIEVE:
+    def __init__(self, size):
+        self.size = size
+        self.queue = []
+        self.visited = {}
+        self.hand = None
+        self.hits = 0
+
+    def evict(self):
+        position = self.hand if self.hand is not None else len(self.queue) - 1
+        while self.visited[self.queue[position]]:
+            self.visited[self.queue[position]] = False
+            position = position - 1 if position > 0 else len(self.queue) - 1
+        del self.visited[self.queue[position]]
+        del self.queue[position]
+        # Entries before the evicted one keep their positions
+        self.hand = position - 1 if position > 0 else None
+
+    def get(self, key):
+        if key in self.visited:
+            self.hits += 1
+            self.visited[key] = True
+            return
+        if len(self.queue) == self.size:
+            self.evict()
+        self.queue.insert(0, key)
+        self.visited[key] = False
+        # The new entry shifts the positions by one
+        if self.hand is not None:
+            self.hand += 1
+
+def GenerateAnswer(test):
+    cache_size = int(test[0])
+    test_list = [int(request) for request in test[2:]]
+
+    sieve = SIEVE(cache_size)
+    for index in test_list:
+        sieve.get(index)
+    return sieve.hits
+
+
+class CmdArgs:
+    number_of_tests = 0
+    output_path = "./resources"
+
+    def __init__(self):
+        pass
+
+def Generate_N_Random_Tests (cmd):
+    for test_number in range(cmd.number_of_tests):
+        test_str = GenerateRandomTest(test_number)
+        with open (os.path.join(cmd.output_path, "test{}.dat".format(test_number)), 'w+') as test_file:
+            test_file.write("{}".format(" ".join(test_str)))
+        answ = GenerateAnswer(test_str)
+        with open (os.path.join(cmd.output_path, "answ{}.dat".format(test_number)), "w+") as answer_file:
+            answer_file.write("{}\n".format(answ))
+
+
+
+def main (argv):
+    cmd = CmdArgs()
+    try:
+        opts, args = getopt.getopt(argv, "hn:o:")
+    except getopt.GetoptError:
+        print(usage_string)
+        sys.exit()
+    for opt, arg in opts:
+        if opt == "-h":
+            print(usage_string)
+            sys.exit()
+        if opt in ("-o", "--output"):
+            cmd.output_path = str(arg)
+        if opt in ("-n", "--number"):
+            cmd.number_of_tests = int(arg)
+
+    Generate_N_Random_Tests (cmd)
+
+
+
+main(sys.argv[1:])
@@ -0,0 +1,183 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "error.h"
+
+#include "lfu.h"
+#include "lfuda.h"
+#include "sieve.h"
+
+// Pages of variable length are checked in two ways. When all pages have the same length and the byte capacity is never
+// reached, caches with get_sized must behave exactly like the ones with get and data_size. With lengths that differ a
+// lot the byte capacity must never be exceeded, and every page returned from the cache must be the one that was loaded
+
+typedef struct {
+    int value;
+} index_t;
+
+static unsigned long index_hash(index_t *a) {
+    return (unsigned long)(a->value);
+}
+
+static int index_cmp(index_t *a, index_t *b) {
+    return (a->value > b->value) - (a->value < b->value);
+}
+
+#define MAX_LENGTH   3000
+#define FIXED_LENGTH 100
+
+static unsigned char page_buffer[MAX_LENGTH];
+
+// Lengths vary from empty pages to ones that take several slab classes
+static size_t page_length(int index) {
+    return (size_t)(index * 7919) % MAX_LENGTH;
+}
+
+static void fill_page(int index, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        page_buffer[i] = (unsigned char)(index + i);
+    }
+}
+
+static void *get_page(index_t *index) {
+    fill_page(index->value, FIXED_LENGTH);
+    return page_buffer;
+}
+
+static void *get_fixed_sized_page(index_t *index, size_t *length) {
+    *length = FIXED_LENGTH;
+    return get_page(index);
+}
+
+static void *get_sized_page(index_t *index, size_t *length) {
+    *length = page_length(index->value);
+    fill_page(index->value, *length);
+    return page_buffer;
+}
+
+static int check_page(int index, const unsigned char *page, size_t length, size_t expected) {
+    if (length != expected) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        if (page[i] != (unsigned char)(index + i)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static unsigned long long rand_state = 7;
+
+// Skewed keys, so that there are both frequently and rarely used entries
+static int next_index(void) {
+    rand_state = rand_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    unsigned long long r = rand_state >> 33;
+    return (int)(r % (1 + r % 2048));
+}
+
+#define CACHE_SIZE 256
+#define CAPACITY   (64 * 1024)
+#define REQUESTS   200000
+
+// All policies behind the same interface
+typedef struct {
+    const char *name;
+    void *(*init)(cache_init_t init);
+    void (*free)(void *cache);
+    void *(*get_sized)(void *cache, void *index, size_t *length);
+    size_t (*get_hits)(void *cache);
+    size_t (*get_used)(void *cache);
+} policy_t;
+
+static const policy_t policies[] = {
+    {"LFU", lfu_init, lfu_free, lfu_get_sized, lfu_get_hits, lfu_get_used},
+    {"LFU-DA", lfuda_init, lfuda_free, lfuda_get_sized, lfuda_get_hits, lfuda_get_used},
+    {"SIEVE", sieve_init, sieve_free, sieve_get_sized, sieve_get_hits, sieve_get_used},
+};
+
+static int test_same_length(const policy_t *policy) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(get_page),
+        .size = CACHE_SIZE,
+        .data_size = FIXED_LENGTH,
+        .key_size = sizeof(index_t),
+    };
+    void *fixed = policy->init(init);
+
+    init.get = NULL;
+    init.data_size = 0;
+    init.get_sized = CACHE_GET_SIZED_F(get_fixed_sized_page);
+    init.capacity = SIZE_MAX;
+    void *sized = policy->init(init);
+
+    int failed = 0;
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        index_t index = {next_index()};
+        size_t length = 0;
+
+        policy->get_sized(fixed, &index, &length);
+        const unsigned char *page = policy->get_sized(sized, &index, &length);
+
+        if (policy->get_hits(fixed) != policy->get_hits(sized) ||
+            !check_page(index.value, page, length, FIXED_LENGTH)) {
+            fprintf(stderr, "%s: pages of the same length diverged at request %lu\n", policy->name, r);
+            failed = 1;
+        }
+    }
+
+    policy->free(fixed);
+    policy->free(sized);
+
+    return failed;
+}
+
+static int test_variable_length(const policy_t *policy) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get_sized = CACHE_GET_SIZED_F(get_sized_page),
+        .size = CACHE_SIZE,
+        .capacity = CAPACITY,
+        .key_size = sizeof(index_t),
+    };
+    void *cache = policy->init(init);
+
+    int failed = 0;
+    for (size_t r = 0; r < REQUESTS && !failed; ++r) {
+        index_t index = {next_index()};
+        size_t length = 0;
+
+        const unsigned char *page = policy->get_sized(cache, &index, &length);
+
+        if (!check_page(index.value, page, length, page_length(index.value))) {
+            fprintf(stderr, "%s: wrong page for %d at request %lu\n", policy->name, index.value, r);
+            failed = 1;
+        } else if (policy->get_used(cache) > CAPACITY) {
+            fprintf(stderr, "%s: %lu bytes used at request %lu\n", policy->name, policy->get_used(cache), r);
+            failed = 1;
+        }
+    }
+
+    printf("%s: hits %lu, used %lu\n", policy->name, policy->get_hits(cache), policy->get_used(cache));
+
+    policy->free(cache);
+
+    return failed;
+}
+
+int main(void) {
+    int failed = 0;
+
+    for (size_t i = 0; i < sizeof(policies) / sizeof(policies[0]); ++i) {
+        failed |= test_same_length(&policies[i]);
+        failed |= test_variable_length(&policies[i]);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
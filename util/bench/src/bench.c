@@ -0,0 +1,204 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "error.h"
+#include "memutil.h"
+
+#include "arc.h"
+#include "sieve.h"
+#include "lfu.h"
+#include "lfuda.h"
+
+// Benchmark of the generic caches against the ones specialised for 64-bit keys with cache_tmpl.h. Both run the same
+// trace in the lfudac format: cache size, number of requests and the requests. Exits with failure when the numbers of
+// hits differ, because the policies must be the same. ARC and SIEVE run the trace as well, so that the hits of the
+// policies can be compared
+
+typedef struct {
+    uint64_t page[4];
+} page_t;
+
+//============================================================================================================
+
+// Generic instance, keys are passed by pointer
+static unsigned long index_hash(uint64_t **a) {
+    return (unsigned long)(**a);
+}
+
+static int index_cmp(uint64_t **a, uint64_t **b) {
+    return (**a != **b);
+}
+
+static void *index_get(uint64_t *index) {
+    static page_t page;
+    page.page[0] = *index;
+    return &page;
+}
+
+//============================================================================================================
+
+// Specialised instance
+static inline unsigned long u64_hash(uint64_t key) {
+    return (unsigned long)key;
+}
+
+static inline int u64_cmp(uint64_t a, uint64_t b) {
+    return (a != b);
+}
+
+static inline page_t u64_get(uint64_t key) {
+    page_t page = {{key}};
+    return page;
+}
+
+#define CACHE_TMPL_PREFIX u64
+#define CACHE_TMPL_KEY    uint64_t
+#define CACHE_TMPL_VALUE  page_t
+#define CACHE_TMPL_HASH   u64_hash
+#define CACHE_TMPL_CMP    u64_cmp
+#define CACHE_TMPL_GET    u64_get
+#include "cache_tmpl.h"
+
+//============================================================================================================
+
+static double bench_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+typedef enum { BENCH_LFU, BENCH_LFUDA, BENCH_U64_LFU, BENCH_U64_LFUDA, BENCH_ARC, BENCH_SIEVE } bench_cache_t;
+
+static const char *bench_names[] = {"lfu", "lfuda", "u64_lfu", "u64_lfuda", "arc", "sieve"};
+
+// Run the trace repeat times on a fresh cache and return the number of hits of the last run
+static size_t bench_run(bench_cache_t type, size_t size, uint64_t *keys, size_t n, size_t repeat, double *time) {
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(index_get),
+        .size = size,
+        .data_size = sizeof(page_t),
+    };
+
+    size_t hits = 0;
+    uint64_t sum = 0;
+    double start = bench_now_ms();
+
+    for (size_t r = 0; r < repeat; r++) {
+        switch (type) {
+        case BENCH_LFU: {
+            lfu_t cache = lfu_init(init);
+            for (size_t i = 0; i < n; i++) {
+                sum += ((page_t *)lfu_get(cache, &keys[i]))->page[0];
+            }
+            hits = lfu_get_hits(cache);
+            lfu_free(cache);
+            break;
+        }
+        case BENCH_LFUDA: {
+            lfuda_t cache = lfuda_init(init);
+            for (size_t i = 0; i < n; i++) {
+                sum += ((page_t *)lfuda_get(cache, &keys[i]))->page[0];
+            }
+            hits = lfuda_get_hits(cache);
+            lfuda_free(cache);
+            break;
+        }
+        case BENCH_U64_LFU: {
+            u64_lfu_t *cache = u64_lfu_init(size);
+            for (size_t i = 0; i < n; i++) {
+                sum += u64_lfu_get(cache, keys[i])->page[0];
+            }
+            hits = u64_lfu_get_hits(cache);
+            u64_lfu_free(cache);
+            break;
+        }
+        case BENCH_U64_LFUDA: {
+            u64_lfuda_t *cache = u64_lfuda_init(size);
+            for (size_t i = 0; i < n; i++) {
+                sum += u64_lfuda_get(cache, keys[i])->page[0];
+            }
+            hits = u64_lfuda_get_hits(cache);
+            u64_lfuda_free(cache);
+            break;
+        }
+        case BENCH_ARC: {
+            arc_t cache = arc_init(init);
+            for (size_t i = 0; i < n; i++) {
+                sum += ((page_t *)arc_get(cache, &keys[i]))->page[0];
+            }
+            hits = arc_get_hits(cache);
+            arc_free(cache);
+            break;
+        }
+        case BENCH_SIEVE: {
+            sieve_t cache = sieve_init(init);
+            for (size_t i = 0; i < n; i++) {
+                sum += ((page_t *)sieve_get(cache, &keys[i]))->page[0];
+            }
+            hits = sieve_get_hits(cache);
+            sieve_free(cache);
+            break;
+        }
+        }
+    }
+
+    *time = bench_now_ms() - start;
+
+    // Every get returns the page of the requested key
+    uint64_t expected = 0;
+    for (size_t i = 0; i < n; i++) {
+        expected += keys[i];
+    }
+    if (sum != expected * repeat) {
+        ERROR("%s returned wrong pages\n", bench_names[type]);
+    }
+
+    return hits;
+}
+
+//============================================================================================================
+
+int main(int argc, char *argv[]) {
+    // Usage: bench [trace] [repeat], the trace is read from stdin by default
+    FILE *input = (argc > 1 ? fopen(argv[1], "r") : stdin);
+    size_t repeat = (argc > 2 ? strtoul(argv[2], NULL, 10) : 1);
+
+    if (!input) {
+        ERROR("Could not open a file\n");
+    }
+
+    size_t m = 0, n = 0;
+    if (fscanf(input, "%lu %lu", &m, &n) != 2 || !m) {
+        ERROR("Invalid input\n");
+    }
+
+    uint64_t *keys = calloc_checked(n, sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) {
+        long long key = 0;
+        if (fscanf(input, "%lld", &key) != 1) {
+            ERROR("Invalid input\n");
+        }
+        keys[i] = (uint64_t)key;
+    }
+
+    if (input != stdin) {
+        fclose(input);
+    }
+
+    size_t hits[6];
+    for (int type = BENCH_LFU; type <= BENCH_SIEVE; type++) {
+        double time = 0;
+        hits[type] = bench_run(type, m, keys, n, repeat, &time);
+        printf("%-10s hits: %-10lu time: %.2f ms\n", bench_names[type], hits[type], time);
+    }
+
+    free(keys);
+
+    if (hits[BENCH_LFU] != hits[BENCH_U64_LFU] || hits[BENCH_LFUDA] != hits[BENCH_U64_LFUDA]) {
+        ERROR("Specialised caches do not match the generic ones\n");
+    }
+}
@@ -0,0 +1,294 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "error.h"
+#include "memutil.h"
+
+#include "lfuda.h"
+#include "sharded.h"
+
+// Multithreaded benchmark of the sharded LFU-DA cache against a single LFU-DA cache behind one mutex. Every thread runs
+// the trace in the lfudac format from its own offset, and the throughput is printed for 1, 2, 4 and so on up to the
+// given number of threads, together with the number of promotions dropped by the sharded cache. Exits with failure when
+// a get returns a wrong page, when the sharded cache of a single shard has different hits from the plain one, or when
+// threads that miss the same keys at once call the loader more than once for a key
+
+typedef struct {
+    uint64_t page[4];
+} page_t;
+
+//============================================================================================================
+
+// Keys are passed by pointer
+static unsigned long index_hash(uint64_t **a) {
+    return (unsigned long)(**a);
+}
+
+static int index_cmp(uint64_t **a, uint64_t **b) {
+    return (**a != **b);
+}
+
+// Loaders of different shards run at the same time, so every thread has its own page
+static void *index_get(uint64_t *index) {
+    static _Thread_local page_t page;
+    page.page[0] = *index;
+    return &page;
+}
+
+//============================================================================================================
+
+// Number of shards of the sharded cache, unless the cache is smaller
+#define MTBENCH_SHARDS 64
+
+typedef enum { MTBENCH_MUTEX, MTBENCH_SHARDED } mtbench_cache_t;
+
+static const char *mtbench_names[] = {"mutex", "sharded"};
+
+// Single cache behind one mutex, which is what the sharded cache replaces
+typedef struct {
+    pthread_mutex_t lock;
+    lfuda_t cache;
+} mtbench_locked_t;
+
+typedef struct {
+    mtbench_cache_t type;
+    void *cache;
+    uint64_t *keys;
+    size_t n, offset, repeat;
+    int failed;
+} mtbench_thread_t;
+
+//============================================================================================================
+
+static double mtbench_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+//============================================================================================================
+
+static void *mtbench_thread(void *arg_) {
+    mtbench_thread_t *arg = arg_;
+
+    for (size_t r = 0; r < arg->repeat; r++) {
+        for (size_t i = 0; i < arg->n; i++) {
+            uint64_t *key = &arg->keys[(arg->offset + i) % arg->n];
+            page_t page;
+
+            if (arg->type == MTBENCH_SHARDED) {
+                sharded_get(arg->cache, key, &page);
+            } else {
+                mtbench_locked_t *locked = arg->cache;
+                pthread_mutex_lock(&locked->lock);
+                page = *(page_t *)lfuda_get(locked->cache, key);
+                pthread_mutex_unlock(&locked->lock);
+            }
+
+            arg->failed |= (page.page[0] != *key);
+        }
+    }
+
+    return NULL;
+}
+
+//============================================================================================================
+
+// Run the trace repeat times in each of nthreads threads and return the number of gets per microsecond. Promotions
+// dropped by the sharded cache are stored in dropped
+static double mtbench_run(mtbench_cache_t type, cache_init_t init, uint64_t *keys, size_t n, size_t repeat,
+                          size_t nthreads, size_t *dropped) {
+    mtbench_locked_t locked;
+    void *cache = &locked;
+
+    if (type == MTBENCH_SHARDED) {
+        cache = lfuda_sharded_init(init, (init.size < MTBENCH_SHARDS ? init.size : MTBENCH_SHARDS));
+    } else {
+        pthread_mutex_init(&locked.lock, NULL);
+        locked.cache = lfuda_init(init);
+    }
+
+    pthread_t *threads = calloc_checked(nthreads, sizeof(pthread_t));
+    mtbench_thread_t *args = calloc_checked(nthreads, sizeof(mtbench_thread_t));
+
+    double start = mtbench_now_ms();
+
+    for (size_t t = 0; t < nthreads; t++) {
+        mtbench_thread_t arg = {type, cache, keys, n, n / nthreads * t, repeat, 0};
+        args[t] = arg;
+        if (pthread_create(&threads[t], NULL, mtbench_thread, &args[t])) {
+            ERROR("Could not create a thread\n");
+        }
+    }
+
+    int failed = 0;
+    for (size_t t = 0; t < nthreads; t++) {
+        pthread_join(threads[t], NULL);
+        failed |= args[t].failed;
+    }
+
+    double time = mtbench_now_ms() - start;
+
+    if (failed) {
+        ERROR("%s returned wrong pages\n", mtbench_names[type]);
+    }
+
+    if (type == MTBENCH_SHARDED) {
+        *dropped = sharded_get_dropped(cache);
+        sharded_free(cache);
+    } else {
+        pthread_mutex_destroy(&locked.lock);
+        lfuda_free(locked.cache);
+    }
+
+    free(threads);
+    free(args);
+
+    return (double)(n * repeat * nthreads) / (time * 1e3);
+}
+
+//============================================================================================================
+
+// With a single shard and a single thread the sharded cache must behave exactly like the plain one
+static void mtbench_check_single(cache_init_t init, uint64_t *keys, size_t n) {
+    lfuda_t plain = lfuda_init(init);
+    sharded_t sharded = lfuda_sharded_init(init, 1);
+
+    for (size_t i = 0; i < n; i++) {
+        page_t page;
+        lfuda_get(plain, &keys[i]);
+        sharded_get(sharded, &keys[i], &page);
+    }
+
+    if (lfuda_get_hits(plain) != sharded_get_hits(sharded) || lfuda_get_age(plain) != sharded_get_age(sharded)) {
+        ERROR("Sharded cache of a single shard does not match the plain one\n");
+    }
+
+    printf("single shard hits: %lu age: %lu\n", sharded_get_hits(sharded), sharded_get_age(sharded));
+
+    lfuda_free(plain);
+    sharded_free(sharded);
+}
+
+//============================================================================================================
+
+#define MTBENCH_SLOW_KEYS 256
+
+static atomic_size_t mtbench_loads;
+
+// Loader of a database, which is slow enough for the threads to miss the same keys at the same time
+static void *mtbench_slow_get(uint64_t *index) {
+    struct timespec delay = {0, 100000};
+    nanosleep(&delay, NULL);
+    atomic_fetch_add(&mtbench_loads, 1);
+    return index_get(index);
+}
+
+static void *mtbench_slow_thread(void *arg_) {
+    mtbench_thread_t *arg = arg_;
+
+    for (size_t i = 0; i < arg->n; i++) {
+        page_t page;
+        sharded_get(arg->cache, &arg->keys[i], &page);
+        arg->failed |= (page.page[0] != arg->keys[i]);
+    }
+
+    return NULL;
+}
+
+// Threads that request the same keys at once must load every key only once, when nothing is evicted
+static void mtbench_check_coalesced(cache_init_t init, size_t nthreads) {
+    uint64_t keys[MTBENCH_SLOW_KEYS];
+    for (size_t i = 0; i < MTBENCH_SLOW_KEYS; i++) {
+        keys[i] = i;
+    }
+
+    init.get = CACHE_GET_F(mtbench_slow_get);
+    init.size = MTBENCH_SLOW_KEYS * MTBENCH_SHARDS;
+    sharded_t cache = lfuda_sharded_init(init, MTBENCH_SHARDS);
+
+    pthread_t *threads = calloc_checked(nthreads, sizeof(pthread_t));
+    mtbench_thread_t *args = calloc_checked(nthreads, sizeof(mtbench_thread_t));
+
+    for (size_t t = 0; t < nthreads; t++) {
+        mtbench_thread_t arg = {MTBENCH_SHARDED, cache, keys, MTBENCH_SLOW_KEYS, 0, 1, 0};
+        args[t] = arg;
+        if (pthread_create(&threads[t], NULL, mtbench_slow_thread, &args[t])) {
+            ERROR("Could not create a thread\n");
+        }
+    }
+
+    int failed = 0;
+    for (size_t t = 0; t < nthreads; t++) {
+        pthread_join(threads[t], NULL);
+        failed |= args[t].failed;
+    }
+
+    size_t loads = atomic_load(&mtbench_loads);
+    if (failed || loads != MTBENCH_SLOW_KEYS) {
+        ERROR("Concurrent misses loaded %lu pages for %d keys\n", loads, MTBENCH_SLOW_KEYS);
+    }
+
+    printf("slow loads: %lu coalesced: %lu\n", loads, sharded_get_coalesced(cache));
+
+    sharded_free(cache);
+    free(threads);
+    free(args);
+}
+
+//============================================================================================================
+
+int main(int argc, char *argv[]) {
+    // Usage: mtbench [trace] [threads] [repeat], the trace is read from stdin by default
+    FILE *input = (argc > 1 ? fopen(argv[1], "r") : stdin);
+    size_t max_threads = (argc > 2 ? strtoul(argv[2], NULL, 10) : 8);
+    size_t repeat = (argc > 3 ? strtoul(argv[3], NULL, 10) : 1);
+
+    if (!input) {
+        ERROR("Could not open a file\n");
+    }
+
+    size_t m = 0, n = 0;
+    if (fscanf(input, "%lu %lu", &m, &n) != 2 || !m || !n) {
+        ERROR("Invalid input\n");
+    }
+
+    uint64_t *keys = calloc_checked(n, sizeof(uint64_t));
+    for (size_t i = 0; i < n; i++) {
+        long long key = 0;
+        if (fscanf(input, "%lld", &key) != 1) {
+            ERROR("Invalid input\n");
+        }
+        keys[i] = (uint64_t)key;
+    }
+
+    if (input != stdin) {
+        fclose(input);
+    }
+
+    cache_init_t init = {
+        .hash = CACHE_HASH_F(index_hash),
+        .cmp = CACHE_CMP_F(index_cmp),
+        .get = CACHE_GET_F(index_get),
+        .size = m,
+        .data_size = sizeof(page_t),
+    };
+
+    mtbench_check_single(init, keys, n);
+    mtbench_check_coalesced(init, max_threads);
+
+    for (size_t nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+        for (int type = MTBENCH_MUTEX; type <= MTBENCH_SHARDED; type++) {
+            size_t dropped = 0;
+            double throughput = mtbench_run(type, init, keys, n, repeat, nthreads, &dropped);
+            printf("%-8s threads: %-3lu gets/us: %-8.2f dropped: %lu\n", mtbench_names[type], nthreads, throughput,
+                   dropped);
+        }
+    }
+
+    free(keys);
+}